@@ -0,0 +1,35 @@
+#ifndef CP_TOOLS_BUILD_H
+#define CP_TOOLS_BUILD_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sh.h"
+
+// Concurrent build of tools and solutions
+namespace cptools::build {
+
+struct Target {
+    std::string output;
+    std::string source;
+    sh::Profile profile;
+};
+
+struct Report {
+    Target target;
+    sh::Result result;
+    double elapsed;
+    bool rebuilt; // False if the output was already up to date
+};
+
+size_t max_jobs();
+
+// Builds all targets concurrently. The callback, if any, is called (one at a time) as soon as
+// each target is finished
+std::vector<Report> run(const std::vector<Target> &targets,
+                        const std::function<void(const Report &)> &on_finish = nullptr);
+
+} // namespace cptools::build
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CP_TOOLS_CACHE_H
+#define CP_TOOLS_CACHE_H
+
+#include <string>
+
+// User-wide, content-addressed cache of build artifacts
+namespace cptools::cache {
+
+struct Settings {
+    bool enabled;
+    std::string dir;
+    long long max_size; // In bytes
+};
+
+// Reads the 'cache' section of the user's config file (~/.cp-tools-config.json)
+Settings load_settings();
+
+// Copies the artifact stored under the given key to dest. Returns false on a miss
+bool fetch(const Settings &settings, const std::string &key, const std::string &dest);
+
+// Stores a copy of the file src under the given key, evicting the least recently used entries
+// if the cache becomes larger than its maximum size
+bool store(const Settings &settings, const std::string &key, const std::string &src);
+
+void evict(const Settings &settings);
+
+} // namespace cptools::cache
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef CP_TOOLS_CONTEST_CONTEST_H
+#define CP_TOOLS_CONTEST_CONTEST_H
+
+#include <iostream>
+
+namespace cptools::commands::contest {
+
+int run(int argc, char *const argv[], std::ostream &out, std::ostream &err);
+
+std::string help();
+std::string usage();
+
+} // namespace cptools::commands::contest
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef CP_TOOLS_CONTEST_PDF_H
+#define CP_TOOLS_CONTEST_PDF_H
+
+#include <ostream>
+#include <string>
+
+namespace cptools::commands::contest::pdf {
+
+int run(int argc, char *const argv[], std::ostream &out, std::ostream &err);
+
+// Label of the problem on the given position of the contest: A, B, ..., Z, AA, AB, ...
+std::string label(size_t index);
+
+} // namespace cptools::commands::contest::pdf
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <iostream>
 
+#include "sh.h"
+
 namespace cptools::commands::judge {
 namespace verdict {
 extern const int AC;
@@ -23,8 +25,17 @@ int run(int argc, char *const argv[], std::ostream &out, std::ostream &err);
 std::string help();
 std::string usage();
 
+// Verdict of a run of a solution on a test, from the resources it used (time limit in ms,
+// memory limit in MB) and, if it finished within the limits, from the checker. The given
+// overhead (zero to keep the raw time) is subtracted from the elapsed time
+int evaluate(sh::Info &info, double overhead, double timelimit, double memory_limit,
+             const std::string &input, const std::string &output, const std::string &answer,
+             int timeout);
+
 // Judge solution
-int judge(const std::string &solution_path, std::ostream &out, std::ostream &err);
+int judge(const std::string &solution_path, const std::string &profile_name, bool sanitize,
+          bool fork_server, bool fail_fast, bool unique, bool subtract_startup, std::ostream &out,
+          std::ostream &err);
 } // namespace cptools::commands::judge
 
 #endif
@@ -0,0 +1,25 @@
+#ifndef CP_TOOLS_COMPRESS_H
+#define CP_TOOLS_COMPRESS_H
+
+#include <string>
+
+#include "fs.h"
+
+// Compressed test files, recognized by their extension: gzip (.gz) and, when cp-tools is built
+// with libzstd, zstd (.zst)
+namespace cptools::compress {
+
+bool is_compressed(const std::string &path);
+
+// Both functions work in blocks, so the files are never loaded whole in memory
+const fs::Result decompress(const std::string &src, const std::string &dst);
+const fs::Result compress(const std::string &src, const std::string &dst);
+
+// Plain version of a file: the file itself, if it is not compressed, or a copy decompressed
+// into the cache directory, named by the hash of the compressed contents
+const fs::Result plain_file(const std::string &path, const std::string &cache_dir,
+                            std::string &plain);
+
+} // namespace cptools::compress
+
+#endif
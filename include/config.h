@@ -5,6 +5,7 @@
 
 #include "fs.h"
 #include "json.hpp"
+#include "sh.h"
 #include "util.h"
 
 namespace cptools::config {
@@ -18,6 +19,14 @@ std::string get_tool_file_name(const nlohmann::json &json_object, const std::str
 std::vector<std::string> get_solutions_file_names(const nlohmann::json &json_object,
                                                   const std::string &tag);
 
+// Named compiler profile, from 'compilers|profiles'. If name is empty, the profile is the one
+// chosen by 'compilers|profile' (or 'default')
+sh::Profile get_compiler_profile(const nlohmann::json &json_object, const std::string &name = "");
+
+// Name of the profile assigned to a solution in 'compilers|solutions' (empty if there is none)
+std::string get_solution_profile_name(const nlohmann::json &json_object,
+                                      const std::string &solution);
+
 template <typename T>
 void modify_config_file(const std::string &path, T new_value, const std::string &op = "replace") {
     auto pointer = util::to_json_pointer(path);
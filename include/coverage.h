@@ -0,0 +1,31 @@
+#ifndef CP_TOOLS_COVERAGE_H
+#define CP_TOOLS_COVERAGE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Coverage of the validator bounds, from the overview logs that testlib validators write when
+// called with --testOverviewLogFileName
+namespace cptools::coverage {
+
+// Tests (in increasing order) that hit the minimum and the maximum value of a variable
+struct Variable {
+    std::vector<int> min_hits;
+    std::vector<int> max_hits;
+};
+
+struct Report {
+    std::map<std::string, Variable> variables;
+    std::map<std::string, std::vector<int>> features; // Tests that hit each feature
+};
+
+// Adds the overview log of a test to the report. Tests must be merged in increasing order
+void merge(Report &report, int test, const std::string &log);
+
+// Compact list of tests, as in "1-3, 7"
+std::string ranges(const std::vector<int> &tests);
+
+} // namespace cptools::coverage
+
+#endif
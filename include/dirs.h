@@ -9,5 +9,7 @@
 #define CP_TOOLS_TEMP_DIR      ".cp-tmp"
 
 #define CP_TOOLS_CONFIG_FILE "." NAME "-config.json"
+#define CP_TOOLS_CACHE_DIR   "." NAME "-cache"
+#define CP_TOOLS_FORMATS_DIR "." NAME "-formats"
 
 #endif
@@ -41,6 +41,8 @@
 #define CP_TOOLS_ERROR_SH_PY_BUILD_ERROR        -105
 #define CP_TOOLS_ERROR_SH_POPEN_FAILED          -106
 #define CP_TOOLS_ERROR_SH_FILE_NOT_FOUND        -107
+#define CP_TOOLS_ERROR_SH_JAVA_BUILD_ERROR      -108
+#define CP_TOOLS_ERROR_SH_C_COMPILATION_ERROR   -109
 
 #define CP_TOOLS_ERROR_CHECK_MISSING_VALIDATOR  -120
 #define CP_TOOLS_ERROR_CHECK_INVALID_INPUT_FILE -121
@@ -49,13 +51,16 @@
 #define CP_TOOLS_ERROR_CHECK_TEST_FAILED        -124
 #define CP_TOOLS_ERROR_CHECK_MISSING_CHECKER    -125
 #define CP_TOOLS_ERROR_CHECK_MISSING_SOLUTION   -126
+#define CP_TOOLS_ERROR_CHECK_SOLUTION_FAILED    -127
 
 #define CP_TOOLS_ERROR_JUDGE_MISSING_CHECKER    -140
 #define CP_TOOLS_ERROR_JUDGE_MISSING_VALIDATOR  -141
 #define CP_TOOLS_ERROR_JUDGE_MISSING_TOOL       -142
 #define CP_TOOLS_ERROR_JUDGE_INVALID_INPUT_FILE -143
+#define CP_TOOLS_ERROR_JUDGE_INVALID_PROFILE    -144
 
-#define CP_TOOLS_ERROR_TASK_INVALID_TOOL -150
+#define CP_TOOLS_ERROR_TASK_INVALID_TOOL      -150
+#define CP_TOOLS_ERROR_TASK_GENERATION_FAILED -151
 
 #define CP_TOOLS_ERROR_POLYGON_INVALID_OPTION      -160
 #define CP_TOOLS_ERROR_POLYGON_MUTUAL_CHOICE_ERROR -161
@@ -63,6 +68,16 @@
 #define CP_TOOLS_ERROR_POLYGON_NO_PROBLEM_ID       -163
 #define CP_TOOLS_ERROR_POLYGON_API                 -164
 
+#define CP_TOOLS_ERROR_COMPRESS_READ        -170
+#define CP_TOOLS_ERROR_COMPRESS_WRITE       -171
+#define CP_TOOLS_ERROR_COMPRESS_UNSUPPORTED -172
+
+#define CP_TOOLS_ERROR_CONTEST_INVALID_OPTION   -180
+#define CP_TOOLS_ERROR_CONTEST_MISSING_PROBLEMS -181
+#define CP_TOOLS_ERROR_CONTEST_INVALID_LANGUAGE -182
+#define CP_TOOLS_ERROR_CONTEST_PROBLEM_FAILED   -183
+#define CP_TOOLS_ERROR_CONTEST_BOOKLET_FAILED   -184
+
 #define CP_TOOLS_EXCEPTION_INEXISTENT_FILE -200
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef CP_TOOLS_FORKSERVER_H
+#define CP_TOOLS_FORKSERVER_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "sh.h"
+
+// Runs C/C++ programs from a snapshot taken right before main(), instead of calling execve() on
+// each run. A stub linked into the program (with -Wl,--wrap=main) waits for requests on a socket
+// and forks a copy of the process for each one, with its stdin and stdout rebound to the given
+// files. The program runs as usual when the stub is not activated
+namespace cptools::forkserver {
+
+struct Server {
+    pid_t pid;
+    int channel; // Socket connected to the stub
+};
+
+// Writes and compiles the stub on the given directory. Returns the extra link options for the
+// programs, which are empty if the stub can't be built
+std::vector<std::string> link_options(const std::string &dir);
+
+// Starts the program in fork-server mode. Returns false (and stops the program) if it doesn't
+// have the stub
+bool start(Server &server, const std::string &program);
+
+// Runs the snapshot once, timed from the fork. The timeout is given in seconds
+sh::Info run(Server &server, const std::string &infile, const std::string &outfile,
+             int timeout = 3);
+
+void stop(Server &server);
+
+} // namespace cptools::forkserver
+
+#endif
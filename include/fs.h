@@ -19,12 +19,18 @@ const Result make_result(bool res, int rc, const std::string err_msg);
 const Result create_directory(const std::string &path);
 const Result exists(const std::string &path);
 const Result copy(const std::string &src, const std::string &dst, bool overwrite = false);
+
+// Places a copy of a file (or of a directory tree) at dst, sharing the storage when possible:
+// with a hard link, if allowed (dst must never be modified, as it is the same file as src), with
+// a reflink, or with an in-kernel copy. Files whose contents are already the same are skipped
+const Result materialize(const std::string &src, const std::string &dst, bool allow_link = false);
 const Result remove(const std::string &path);
 const Result equivalent(const std::string &p1, const std::string &p2);
 const Result is_directory(const std::string &path);
 const Result is_file(const std::string &path);
 
 void overwrite_file(const std::string dst, const std::string content);
+std::string read_file(const std::string &path);
 
 std::string get_home_dir();
 std::string get_default_config_path();
@@ -0,0 +1,23 @@
+#ifndef CP_TOOLS_LATEX_H
+#define CP_TOOLS_LATEX_H
+
+#include <string>
+
+#include "sh.h"
+
+// Incremental builds of the PDF files
+namespace cptools::latex {
+
+// Hash of everything a LaTeX document depends on: its contents, the files named on the arguments
+// of its commands (as the samples and the \input statement files, with or without the '.tex'
+// extension), the files of the problem's 'tex' directory (as the images) and the document class
+std::string sources_hash(const std::string &texfile, const std::string &doc_class);
+
+// Builds the PDF of a LaTeX file, unless it was already built from sources with the same hash.
+// The hash is kept next to the PDF, on a file with the extension '.sources'
+sh::Result build(const std::string &pdf, const std::string &texfile, const std::string &doc_class,
+                 bool &rebuilt);
+
+} // namespace cptools::latex
+
+#endif
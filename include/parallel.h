@@ -0,0 +1,17 @@
+#ifndef CP_TOOLS_PARALLEL_H
+#define CP_TOOLS_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Helpers to spread independent jobs across the available cores
+namespace cptools::parallel {
+
+size_t max_workers();
+
+// Calls f(0), f(1), ..., f(n - 1) using at most 'workers' threads (0 means max_workers())
+void for_each(size_t n, const std::function<void(size_t)> &f, size_t workers = 0);
+
+} // namespace cptools::parallel
+
+#endif
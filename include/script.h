@@ -0,0 +1,44 @@
+#ifndef CP_TOOLS_SCRIPT_H
+#define CP_TOOLS_SCRIPT_H
+
+#include <string>
+#include <vector>
+
+// Generation scripts, in the spirit of Polygon's ones. Each line is either a generator call
+//
+//     gen 10 20 > $             One test, written to the standard output
+//     gen 100 > {1-50}          Tests 1 to 50 of a single run, written with testlib's startTest()
+//     gen 7 > {1,3,5-6}
+//
+// or a loop, whose variable is replaced on the enclosed lines as ${name}
+//
+//     for i in 1..10 [step 2]
+//         gen ${i} > $
+//     end
+//
+// Lines starting with '#' are comments
+namespace cptools::script {
+
+struct Command {
+    std::string generator;
+    std::string args;
+    std::vector<int> tests; // Indexes given to startTest(), empty if the test is the stdout
+};
+
+struct Result {
+    bool ok;
+    std::string error_message;
+    std::vector<Command> commands;
+};
+
+// Limit on the number of tests a script can describe
+constexpr size_t MAX_TESTS = 100000;
+
+// Limit on the number of iterations of all the loops of a script, nested ones included
+constexpr size_t MAX_ITERATIONS = 1000000;
+
+Result expand(const std::string &script);
+
+} // namespace cptools::script
+
+#endif
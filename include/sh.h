@@ -1,7 +1,9 @@
 #ifndef CP_TOOLS_SH_H
 #define CP_TOOLS_SH_H
 
+#include <map>
 #include <string>
+#include <vector>
 
 // Functions that emulates shell commands
 namespace cptools::sh {
@@ -17,15 +19,44 @@ struct Info {
     double memory;
 };
 
+// Compiler (or interpreter) options of a language
+struct Compiler {
+    std::string compiler;
+    std::string standard;
+    std::string optimisation;
+    std::vector<std::string> defines;
+    std::vector<std::string> flags;
+    std::vector<std::string> link;
+    std::vector<std::string> runtime; // Options of the virtual machine/interpreter
+};
+
+// Options for each language, indexed by the extension of the sources. Languages missing on a
+// profile are built with the default options
+using Profile = std::map<std::string, Compiler>;
+
+const Profile &default_profile();
+
+// Modification time, in nanoseconds (0 if the file doesn't exist)
+long long last_modified(const std::string &filepath);
+
 Result diff_dirs(const std::string &dirA, const std::string &dirB);
 
-Result build(const std::string &output, const std::string &src);
+Result build(const std::string &output, const std::string &src, const Profile &profile = {});
 
 Result execute(const std::string &program, const std::string &args, const std::string &infile = "",
                const std::string &outfile = "/dev/null", int timeout = 3);
 
+// Startup cost (in seconds) of a program, measured on its build, that can be subtracted from
+// its running times. It is zero for native programs
+double startup_overhead(const std::string &program);
+
+// Number of pdflatex passes of the last build of a PDF, which runs again while the cross
+// references change
+int tex_passes(const std::string &pdf);
+
 Info profile(const std::string &program, const std::string &args, int timeout = 3,
-             const std::string &infile = "", const std::string &outfile = "/dev/null");
+             const std::string &infile = "", const std::string &outfile = "/dev/null",
+             const std::string &errfile = "");
 } // namespace cptools::sh
 
 #endif
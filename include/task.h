@@ -1,10 +1,15 @@
 #ifndef CP_TOOLS_TASK_H
 #define CP_TOOLS_TASK_H
 
+#include <functional>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "build.h"
+#include "json.hpp"
+
 // Problem preparation related tasks
 namespace cptools::task {
 
@@ -16,12 +21,45 @@ constexpr int INTERACTOR = 8;
 constexpr int ALL = CHECKER | VALIDATOR | GENERATOR | INTERACTOR;
 } // namespace tools
 
+// Called, in order, with the index, the input and the answer of each test, as soon as they are
+// ready, and with the index of the first test with the same input (the test itself, if its input
+// is unique). Returning false stops the generation of the remaining tests
+using TestConsumer = std::function<bool(size_t, size_t original, const std::string &input,
+                                        const std::string &answer)>;
+
+// Generates the tests of the set ("samples", "manual", "random" or "all") on 'workers' threads
+// (0 means all cores), while they are handed to the consumer. Tests with the same input are
+// reported on 'out'
+int stream_io_files(const std::string &testset, std::ostream &out, std::ostream &err,
+                    const TestConsumer &consumer, bool gen_output = true, size_t workers = 0);
+
 std::vector<std::pair<std::string, std::string>> generate_io_files(const std::string &testset,
                                                                    std::ostream &out,
                                                                    std::ostream &err,
                                                                    bool gen_output = true);
 
+// Inputs and answers of the samples, as read by the statements, on their own directory. The
+// answers are keyed by the build of the default solution, which is rebuilt only if it is out of
+// date: they are taken from the manifest of the tests, when they are there, and the solution is
+// run only for the samples whose answers are unknown
+std::vector<std::pair<std::string, std::string>> sample_files(std::ostream &err);
+
+// True if the problem has random tests, from 'tests|random' or from a generation script
+bool has_random_tests(const nlohmann::json &config);
+
+build::Target solution_target();
+
 int build_tools(std::string &error, int tools = tools::ALL, const std::string &where = ".");
+int build_targets(std::string &error, std::ostream &out, int tools,
+                  const std::vector<build::Target> &extra = {}, const std::string &where = ".");
+
+// As above, but the 'optional' targets that fail to compile don't fail the build: the compiler
+// output of each one is recorded on 'optional_errors', indexed by its source
+int build_targets(std::string &error, std::ostream &out, int tools,
+                  const std::vector<build::Target> &extra,
+                  const std::vector<build::Target> &optional,
+                  std::map<std::string, std::string> &optional_errors,
+                  const std::string &where = ".");
 int gen_exe(std::string &error, const std::string &source, const std::string &dest,
             const std::string &where = ".");
 
@@ -19,6 +19,9 @@ nlohmann::json read_json_file(const std::string &config_file_path);
 
 std::string sha_512(const std::string &s);
 
+// Hash of the contents of a file, read in blocks (empty if the file can't be read)
+std::string sha_512_file(const std::string &path);
+
 std::string to_json_pointer(const std::string &s);
 
 template <typename T>
@@ -1,3 +1,3 @@
 # cp-tools bash completion
 
-complete -W "init check clean genpdf gentex judge" cp-tools
+complete -W "init check clean contest genpdf gentex judge polygon" cp-tools
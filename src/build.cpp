@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <set>
+
+#include "build.h"
+#include "parallel.h"
+#include "util.h"
+
+using timer = std::chrono::high_resolution_clock;
+
+namespace cptools::build {
+
+// Estimated peak memory (in MB) of a single compilation: g++ -O2 with testlib.h uses
+// a few hundred megabytes
+static constexpr long long MEMORY_PER_JOB = 512;
+
+static long long available_memory() {
+    std::ifstream in("/proc/meminfo");
+    std::string line;
+
+    while (getline(in, line)) {
+        auto tokens = util::split(line);
+
+        if (tokens.size() >= 2 and tokens[0] == "MemAvailable:")
+            return std::stoll(tokens[1]) / 1024;
+    }
+
+    return -1;
+}
+
+size_t max_jobs() {
+    auto jobs = parallel::max_workers();
+    auto memory = available_memory();
+
+    if (memory >= 0)
+        jobs = std::min<size_t>(jobs, std::max(1LL, memory / MEMORY_PER_JOB));
+
+    return jobs;
+}
+
+std::vector<Report> run(const std::vector<Target> &targets,
+                        const std::function<void(const Report &)> &on_finish) {
+    // The same output can't be built twice at the same time
+    std::vector<Target> unique;
+    std::set<std::string> outputs;
+
+    for (const auto &target : targets)
+        if (outputs.insert(target.output).second)
+            unique.push_back(target);
+
+    std::vector<Report> reports(unique.size());
+    std::mutex mutex;
+
+    parallel::for_each(
+        unique.size(),
+        [&](size_t i) {
+            auto before = sh::last_modified(unique[i].output);
+            auto start = timer::now();
+            auto res = sh::build(unique[i].output, unique[i].source, unique[i].profile);
+            auto end = timer::now();
+
+            auto t = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+            auto rebuilt = before == 0 or sh::last_modified(unique[i].output) != before;
+
+            reports[i] = Report{unique[i], res, t.count(), rebuilt};
+
+            if (on_finish) {
+                std::lock_guard<std::mutex> lock(mutex);
+                on_finish(reports[i]);
+            }
+        },
+        max_jobs());
+
+    return reports;
+}
+
+} // namespace cptools::build
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "cache.h"
+#include "dirs.h"
+#include "fs.h"
+#include "util.h"
+
+namespace cptools::cache {
+
+// Default maximum size of the cache, in MB
+static constexpr long long DEFAULT_MAX_SIZE = 512;
+
+// Temporary files must not collide between processes nor between threads
+static std::string unique_suffix() {
+    auto thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+    return std::to_string(getpid()) + "-" + std::to_string(thread_id);
+}
+
+Settings load_settings() {
+    Settings settings{false, fs::get_home_dir() + "/" + CP_TOOLS_CACHE_DIR, 0};
+    nlohmann::json config;
+
+    try {
+        config = util::read_json_file(fs::get_default_config_path());
+    } catch (const std::exception &) {
+        return settings;
+    }
+
+    settings.enabled = util::get_json_value(config, "cache|enabled", false);
+    settings.dir = util::get_json_value(config, "cache|dir", settings.dir);
+    settings.max_size = util::get_json_value(config, "cache|max_size", DEFAULT_MAX_SIZE);
+    settings.max_size *= 1024 * 1024;
+
+    return settings;
+}
+
+bool fetch(const Settings &settings, const std::string &key, const std::string &dest) {
+    if (not settings.enabled)
+        return false;
+
+    auto entry = settings.dir + "/" + key;
+    std::error_code ec;
+
+    if (not std::filesystem::is_regular_file(entry, ec))
+        return false;
+
+    // Copies to a temporary file first, so dest is never seen half written
+    auto tmp = dest + ".cache-" + unique_suffix();
+
+    std::filesystem::copy_file(entry, tmp, std::filesystem::copy_options::overwrite_existing,
+                               ec);
+
+    if (not ec)
+        std::filesystem::rename(tmp, dest, ec);
+
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    // The modification time of an entry is its last use
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+
+    return true;
+}
+
+bool store(const Settings &settings, const std::string &key, const std::string &src) {
+    if (not settings.enabled)
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(settings.dir, ec);
+
+    auto entry = settings.dir + "/" + key;
+    auto tmp = entry + ".tmp-" + unique_suffix();
+
+    std::filesystem::copy_file(src, tmp, std::filesystem::copy_options::overwrite_existing, ec);
+
+    if (not ec)
+        std::filesystem::rename(tmp, entry, ec);
+
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    evict(settings);
+
+    return true;
+}
+
+void evict(const Settings &settings) {
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+    long long total = 0;
+    std::error_code ec;
+
+    for (const auto &entry : std::filesystem::directory_iterator(settings.dir, ec)) {
+        if (not entry.is_regular_file(ec))
+            continue;
+
+        total += entry.file_size(ec);
+        entries.emplace_back(entry.last_write_time(ec), entry.path());
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    for (const auto &[_, path] : entries) {
+        if (total <= settings.max_size)
+            break;
+
+        auto size = std::filesystem::file_size(path, ec);
+
+        if (std::filesystem::remove(path, ec))
+            total -= size;
+    }
+}
+
+} // namespace cptools::cache
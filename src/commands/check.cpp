@@ -1,16 +1,27 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <getopt.h>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <unistd.h>
 
 #include "commands/check.h"
+#include "commands/judge.h"
 #include "config.h"
+#include "coverage.h"
 #include "defs.h"
 #include "dirs.h"
 #include "error.h"
 #include "fs.h"
+#include "format.h"
 #include "message.h"
+#include "parallel.h"
 #include "sh.h"
+#include "table.h"
 #include "task.h"
 #include "util.h"
 
@@ -21,8 +32,8 @@ Verify problem files and tools.
 
     Option          Description
 
-    -a              Validates everything (default option).
-    --all
+    -a              Validates everything (default option). The tools and solutions are built
+    --all           once and the checks above run concurrently.
 
     -c              Validates the checker.
     --checker
@@ -30,8 +41,9 @@ Verify problem files and tools.
     -h              Generates this help message.
     --help
 
-    -s              Validates the solutions.
-    --solutions
+    -s              Judges the tagged solutions concurrently: 'ac' ones must pass all tests,
+    --solutions     and the 'wa', 'pe', 'tle', 'rte' and 'mle' ones must get their verdict on
+                    some test and no other verdict but 'AC' (a 'wa' may also get 'PE').
 
     -t              Validates the tests.
     --tests
@@ -68,65 +80,129 @@ std::string usage() { return "Usage: " NAME " check [-h] [-a] [-c] [-s] [-t] [-v
 
 std::string help() { return usage() + help_message; }
 
-int validate_checker(std::ostream &out, std::ostream &err) {
-    out << message::info("Creating directory " CP_TOOLS_BUILD_DIR);
-    auto fs_res = fs::create_directory(CP_TOOLS_BUILD_DIR);
-    if (not fs_res.ok) {
-        err << message::failure(fs_res.error_message);
-        return fs_res.rc;
-    }
+// Verdicts expected from the solutions of each tag: 'ac' solutions must pass all tests, the
+// others must fail at least one test with one of their verdicts (a presentation error is also a
+// wrong answer, as in Polygon)
+static std::map<std::string, std::set<int>> tag_verdicts{
+    {"ac", {}},
+    {"wa", {judge::verdict::WA, judge::verdict::PE}},
+    {"pe", {judge::verdict::PE}},
+    {"tle", {judge::verdict::TLE}},
+    {"rte", {judge::verdict::RTE}},
+    {"mle", {judge::verdict::MLE}},
+};
 
-    auto validator{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
-    auto config = cptools::config::read_config_file();
-    auto source = cptools::util::get_json_value(config, "tools|validator", std::string("ERROR"));
+struct Solution {
+    std::string tag;
+    build::Target target;
+};
 
-    if (source == "ERROR") {
-        err << "[validate_validator] Validator file not found!\n";
-        return CP_TOOLS_ERROR_CHECK_MISSING_VALIDATOR;
-    }
+// Solutions listed under 'solutions|<tag>', except the default one
+static std::vector<Solution> tagged_solutions(const nlohmann::json &config) {
+    std::vector<Solution> solutions;
+    auto dir = std::string(CP_TOOLS_BUILD_DIR) + "/solutions/";
 
-    auto res = cptools::sh::build(validator, source);
+    auto tags = util::get_json_value(config, "solutions", nlohmann::json::object());
 
-    if (res.rc != CP_TOOLS_OK) {
-        err << message::failure("Can't compile validator '" + source + "'!") << "\n";
-        err << message::trace(res.output) << '\n';
-        return res.rc;
-    }
+    for (auto it = tags.begin(); it != tags.end(); ++it) {
+        if (not it->is_array())
+            continue;
 
-    source = cptools::util::get_json_value(config, "tools|checker", std::string("ERROR"));
+        for (auto path : it->get<std::vector<std::string>>()) {
+            auto name = path;
 
-    if (source == "ERROR") {
-        err << "[validate_checker] Checker file not found!\n";
-        return CP_TOOLS_ERROR_CHECK_MISSING_CHECKER;
+            std::replace(name.begin(), name.end(), '/', '-');
+
+            solutions.push_back(
+                {it.key(),
+                 {dir + name, path,
+                  config::get_compiler_profile(
+                      config, config::get_solution_profile_name(config, path))}});
+        }
     }
 
-    auto checker{std::string(CP_TOOLS_BUILD_DIR) + "/checker"};
+    return solutions;
+}
 
-    res = cptools::sh::build(checker, source);
+// Tools needed to make the tests
+static int test_tools(const nlohmann::json &config) {
+    int tools = task::tools::VALIDATOR;
 
-    if (res.rc != CP_TOOLS_OK) {
-        err << message::failure("Can't compile checker '" + source + "'!") << "\n";
-        err << message::trace(res.output) << '\n';
-        return res.rc;
-    }
+    if (task::has_random_tests(config) and
+        not util::get_json_value(config, "tools|generator", std::string()).empty())
+        tools |= task::tools::GENERATOR;
 
-    source = cptools::util::get_json_value(config, "solutions|default", std::string("ERROR"));
+    return tools;
+}
 
-    if (source == "ERROR") {
-        err << "[validate_checker] Default solution file not found!\n";
-        return CP_TOOLS_ERROR_CHECK_MISSING_VALIDATOR;
+// Each case of a self-test keeps its own failure, so all of them are reported at once
+struct Failure {
+    int rc;
+    std::string report;
+};
+
+// Reports the failures in the order of the cases and returns the code of the first one
+static int report_failures(const std::vector<Failure> &failures, std::ostream &out,
+                           std::ostream &err, const std::string &cases = "tests") {
+    int rc = CP_TOOLS_OK, count = 0;
+
+    for (const auto &failure : failures) {
+        if (failure.rc == CP_TOOLS_OK)
+            continue;
+
+        err << failure.report;
+        rc = rc == CP_TOOLS_OK ? failure.rc : rc;
+        ++count;
     }
 
-    auto solution{std::string(CP_TOOLS_BUILD_DIR) + "/solution"};
+    if (rc == CP_TOOLS_OK)
+        out << message::success() << "\n";
+    else
+        err << message::failure(std::to_string(count) + " of " +
+                                std::to_string(failures.size()) + " " + cases + " failed")
+            << '\n';
 
-    res = cptools::sh::build(solution, source);
+    return rc;
+}
 
-    if (res.rc != CP_TOOLS_OK) {
-        err << message::failure("Can't compile solution '" + source + "'!") << "\n";
-        err << message::trace(res.output) << '\n';
-        return res.rc;
+// Output of the default solution on an input of the checker tests. The outputs are kept in the
+// build directory, named by the hashes of the solution and of the input, so they are computed
+// again only when one of them changes
+static int reference_output(const std::string &solution_hash, const std::string &input,
+                            std::string &output, std::string &error) {
+    auto program = task::solution_target().output;
+    auto dir = std::string(CP_TOOLS_BUILD_DIR) + "/references/";
+
+    output = dir + util::sha_512(solution_hash + "\n" + util::sha_512_file(input)).substr(0, 64);
+
+    if (fs::is_file(output).ok)
+        return CP_TOOLS_OK;
+
+    fs::create_directory(dir);
+
+    // Written aside, so an interrupted run (or another case with the same input, running at the
+    // same time) never sees a partial output
+    static std::atomic<int> calls{0};
+    auto tmp = output + ".tmp-" + std::to_string(calls++);
+    auto result = sh::execute(program, "", input, tmp);
+
+    if (result.rc != CP_TOOLS_OK or rename(tmp.c_str(), output.c_str()) == -1) {
+        fs::remove(tmp);
+        error = result.output;
+        return result.rc == CP_TOOLS_OK ? CP_TOOLS_ERROR_CHECK_TEST_FAILED : result.rc;
     }
 
+    return CP_TOOLS_OK;
+}
+
+// The stages below expect the tools they use to be already built
+static int test_checker(const nlohmann::json &config, std::ostream &out, std::ostream &err) {
+    auto validator{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
+    auto checker{std::string(CP_TOOLS_BUILD_DIR) + "/checker"};
+    auto solution = task::solution_target();
+    auto solution_hash = util::sha_512(util::sha_512_file(solution.output) + "\n" +
+                                       util::sha_512_file(solution.source));
+
     auto tests = cptools::util::get_json_value(
         config, "tests|checker", std::map<std::string, std::pair<std::string, std::string>>{});
 
@@ -137,109 +213,317 @@ int validate_checker(std::ostream &out, std::ostream &err) {
 
     out << message::info("Testing the checker (" + std::to_string(tests.size()) + " tests) ...\n");
 
-    for (auto [input, data] : tests) {
+    std::vector<std::pair<std::string, std::pair<std::string, std::string>>> cases(tests.begin(),
+                                                                                  tests.end());
+    std::vector<Failure> failures(cases.size(), {CP_TOOLS_OK, ""});
+
+    parallel::for_each(cases.size(), [&](size_t i) {
+        auto [input, data] = cases[i];
         auto [output, verdict] = data;
+        auto &failure = failures[i];
 
         if (rcodes.find(verdict) == rcodes.end()) {
-            err << "[validate_checker] Invalid verdict: '" << verdict << "'\n";
-            return CP_TOOLS_ERROR_CHECK_INVALID_VEREDICT;
+            failure = {CP_TOOLS_ERROR_CHECK_INVALID_VEREDICT,
+                       "[validate_checker] Invalid verdict: '" + verdict + "'\n"};
+            return;
         }
 
         auto result = sh::execute(validator, "", input, "");
 
         if (result.rc != CP_TOOLS_OK) {
-            err << message::failure("Input file '" + input + "' is invalid!") << "\n";
-            err << message::trace(result.output) << '\n';
-            return CP_TOOLS_ERROR_CHECK_INVALID_INPUT_FILE;
+            failure = {CP_TOOLS_ERROR_CHECK_INVALID_INPUT_FILE,
+                       message::failure("Input file '" + input + "' is invalid!") + "\n" +
+                           message::trace(result.output) + "\n"};
+            return;
         }
 
-        auto res{std::string(CP_TOOLS_BUILD_DIR) + "/.res"};
-
-        result = sh::execute(solution, "", input, res);
+        std::string res, error;
+        auto rc = reference_output(solution_hash, input, res, error);
 
-        if (result.rc != CP_TOOLS_OK) {
-            err << message::failure("Can't generatate output for input '" + input + "'!") << "\n";
-            err << message::trace(result.output) << '\n';
-            return result.rc;
+        if (rc != CP_TOOLS_OK) {
+            failure = {rc, message::failure("Can't generatate output for input '" + input + "'!") +
+                               "\n" + message::trace(error) + "\n"};
+            return;
         }
 
         auto args{input + " " + output + " " + res};
-        auto expected = rcodes[verdict];
+        auto expected = rcodes.at(verdict);
         auto got = sh::execute(checker, args, "", "");
 
         if (got.rc != expected) {
             std::ostringstream oss;
 
             oss << got.output;
-            oss << "Got: " << mcodes[got.rc] << ", expected: " << mcodes[expected] << '\n';
-
-            err << message::failure("Test '" + input + "' failed!") << "\n";
-            err << message::trace(oss.str());
+            oss << "Got: " << (mcodes.count(got.rc) ? mcodes.at(got.rc) : std::to_string(got.rc))
+                << ", expected: " << mcodes.at(expected) << '\n';
 
-            return CP_TOOLS_ERROR_CHECK_TEST_FAILED;
+            failure = {CP_TOOLS_ERROR_CHECK_TEST_FAILED,
+                       message::failure("Test '" + input + "' failed!") + "\n" +
+                           message::trace(oss.str())};
         }
+    });
+
+    return report_failures(failures, out, err);
+}
+
+static int test_validator(const nlohmann::json &config, std::ostream &out, std::ostream &err) {
+    auto program{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
+    auto tests = cptools::util::get_json_value(config, "tests|validator",
+                                               std::map<std::string, std::string>{});
+
+    if (tests.empty()) {
+        err << "[validate_validator] There are no tests for the validator\n";
+        return CP_TOOLS_ERROR_CHECK_MISSING_TESTS;
     }
 
-    out << message::success() << "\n";
+    out << message::info("Testing the validator (" + std::to_string(tests.size()) +
+                         " tests) ...\n");
 
-    return CP_TOOLS_OK;
+    std::vector<std::pair<std::string, std::string>> cases(tests.begin(), tests.end());
+    std::vector<Failure> failures(cases.size(), {CP_TOOLS_OK, ""});
+
+    parallel::for_each(cases.size(), [&](size_t i) {
+        auto [input, verdict] = cases[i];
+        auto result = sh::execute(program, "", input, "");
+
+        std::string res = (result.output.find("FAIL") == std::string::npos ? "OK" : "INVALID");
+
+        if (verdict != res)
+            failures[i] = {CP_TOOLS_ERROR_CHECK_TEST_FAILED,
+                           message::failure("Input '" + input + " is invalid: expected = '" +
+                                            verdict + "', got = '" + res + "'\n") +
+                               message::trace(result.output.empty() ? "Test valid!"
+                                                                    : result.output) +
+                               "\n"};
+    });
+
+    return report_failures(failures, out, err);
 }
 
-int validate_validator(std::ostream &out, std::ostream &err) {
-    out << message::info("Creating directory " CP_TOOLS_BUILD_DIR);
-    auto fs_res = fs::create_directory(CP_TOOLS_BUILD_DIR);
-    if (not fs_res.ok) {
-        err << message::failure(fs_res.error_message);
-        return fs_res.rc;
+// Tests that hit a bound, shortened to fit the coverage table
+static std::string hits(const std::vector<int> &tests) {
+    const size_t width = 24;
+    auto text = coverage::ranges(tests);
+
+    if (text.empty())
+        return "-";
+
+    if (text.size() > width)
+        text = text.substr(0, text.rfind(", ", width - 5)) + ", ...";
+
+    return text;
+}
+
+static void print_coverage(const coverage::Report &report, std::ostream &out) {
+    table::Table summary{{
+        {"Variable", 16, format::align::LEFT | format::emph::BOLD},
+        {"Min hit on", 24, format::align::LEFT | format::emph::BOLD},
+        {"Max hit on", 24, format::align::LEFT | format::emph::BOLD},
+    }};
+
+    std::vector<std::string> missing;
+
+    for (auto [name, variable] : report.variables) {
+        summary.add_row({{name, format::align::LEFT | format::emph::BOLD},
+                         {hits(variable.min_hits), variable.min_hits.empty()
+                                                       ? format::style::WA
+                                                       : format::style::AC},
+                         {hits(variable.max_hits), variable.max_hits.empty()
+                                                       ? format::style::WA
+                                                       : format::style::AC}});
+
+        if (variable.min_hits.empty())
+            missing.push_back("the minimum of '" + name + "'");
+
+        if (variable.max_hits.empty())
+            missing.push_back("the maximum of '" + name + "'");
+    }
+
+    for (auto [name, tests] : report.features) {
+        summary.add_row({{"feature " + name, format::align::LEFT | format::emph::BOLD},
+                         {hits(tests), tests.empty() ? format::style::WA : format::style::AC}});
+
+        if (tests.empty())
+            missing.push_back("the feature '" + name + "'");
     }
 
+    out << message::info("Validator coverage:") << '\n' << summary << '\n';
+
+    for (auto bound : missing)
+        out << message::warning("No test hits " + bound) << '\n';
+}
+
+// The inputs are validated in parallel, while testlib validators write which bounds each input
+// hits, merged at the end into the coverage table
+static int validate_inputs(const std::vector<std::pair<std::string, std::string>> &io_files,
+                           std::ostream &out, std::ostream &err) {
     auto program{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
-    auto config = cptools::config::read_config_file();
-    auto source = cptools::util::get_json_value(config, "tools|validator", std::string("ERROR"));
+    auto logs_dir{std::string(CP_TOOLS_BUILD_DIR) + "/overview/"};
 
-    if (source == "ERROR") {
-        err << "[validate_validator] Default solution file not found!\n";
-        return CP_TOOLS_ERROR_CHECK_MISSING_VALIDATOR;
+    if (io_files.empty()) {
+        err << message::failure("There are no io files to validate!\n");
+        return CP_TOOLS_ERROR_CHECK_MISSING_IO_FILES;
     }
 
-    auto res = cptools::sh::build(program, source);
+    out << message::info("Validating the input files (" + std::to_string(io_files.size()) +
+                         " tests) ...\n");
 
-    if (res.rc != CP_TOOLS_OK) {
-        err << message::failure("Can't compile validator '" + source + "'!") << "\n";
-        err << message::trace(res.output) << '\n';
-        return res.rc;
+    fs::remove(logs_dir);
+    fs::create_directory(logs_dir);
+
+    std::vector<Failure> failures(io_files.size(), {CP_TOOLS_OK, ""});
+
+    parallel::for_each(io_files.size(), [&](size_t i) {
+        auto input = io_files[i].first;
+        auto log = logs_dir + std::to_string(i + 1);
+        auto result = sh::execute(program, "--testOverviewLogFileName " + log, input, "");
+
+        if (result.rc != CP_TOOLS_OK)
+            failures[i] = {CP_TOOLS_ERROR_CHECK_INVALID_INPUT_FILE,
+                           message::failure("Input file '" + input + "' is invalid!\n") +
+                               message::trace(result.output) + "\n"};
+    });
+
+    auto rc = report_failures(failures, out, err);
+
+    // Validators that don't use testlib write no logs, and have no coverage to show
+    coverage::Report report;
+
+    for (size_t i = 0; i < io_files.size(); ++i) {
+        auto log = logs_dir + std::to_string(i + 1);
+
+        if (fs::is_file(log).ok)
+            coverage::merge(report, i + 1, fs::read_file(log));
     }
 
-    auto tests = cptools::util::get_json_value(config, "tests|validator",
-                                               std::map<std::string, std::string>{});
+    if (rc == CP_TOOLS_OK and not(report.variables.empty() and report.features.empty()))
+        print_coverage(report, out);
 
-    if (tests.empty()) {
-        err << "[validate_validator] There are no tests for the validator\n";
-        return CP_TOOLS_ERROR_CHECK_MISSING_TESTS;
+    return rc;
+}
+
+// Letters of the verdicts on the matrix of the tagged solutions
+static std::map<int, char> verdict_letters{
+    {judge::verdict::AC, '.'},  {judge::verdict::WA, 'W'},  {judge::verdict::PE, 'P'},
+    {judge::verdict::TLE, 'T'}, {judge::verdict::RTE, 'R'}, {judge::verdict::MLE, 'M'},
+};
+
+// Each tagged solution is judged on its own thread, on the tests in order. Besides 'AC', only the
+// verdicts of its tag are allowed, so a run stops on the first test with any other verdict: the
+// solution has already failed. Otherwise it must get a verdict of its tag on some test
+static int test_solutions(const nlohmann::json &config,
+                          const std::vector<std::pair<std::string, std::string>> &io_files,
+                          const std::map<std::string, std::string> &compile_errors,
+                          std::ostream &out, std::ostream &err) {
+    double timelimit = util::get_json_value(config, "problem|timelimit", 1000);
+    double memory_limit = util::get_json_value(config, "problem|memory_limit", 1000);
+    auto solutions = tagged_solutions(config);
+
+    if (io_files.empty()) {
+        err << message::failure("There are no io files to judge the solutions!\n");
+        return CP_TOOLS_ERROR_CHECK_MISSING_IO_FILES;
     }
 
-    out << message::info("Testing the validator (" + std::to_string(tests.size()) +
-                         " tests) ...\n");
+    out << message::info("Judging the tagged solutions (" + std::to_string(solutions.size()) +
+                         " solutions) ...\n");
 
-    for (auto [input, verdict] : tests) {
-        auto result = sh::execute(program, "", input, "");
+    // Row of the matrix of each solution: a letter for each test, '-' on the skipped ones
+    std::vector<std::string> rows(solutions.size(), std::string(io_files.size(), '-'));
+    std::vector<Failure> failures(solutions.size(), {CP_TOOLS_OK, ""});
 
-        std::string res = (result.output.find("FAIL") == std::string::npos ? "OK" : "INVALID");
+    auto judge_solution = [&](size_t i) {
+        auto [tag, target] = solutions[i];
+
+        if (not tag_verdicts.count(tag)) {
+            rows[i].clear();
+            return;
+        }
 
-        if (verdict != res) {
-            err << message::failure("Input '" + input + " is invalid: expected = '" + verdict +
-                                    "', got = '" + res + "'\n");
-            err << message::trace(result.output.empty() ? "Test valid!" : result.output) << '\n';
-            return result.rc;
+        if (compile_errors.count(target.source)) {
+            rows[i].clear();
+            failures[i] = {CP_TOOLS_ERROR_CHECK_SOLUTION_FAILED,
+                           message::failure("Can't compile '" + target.source + "'!") + "\n" +
+                               message::trace(compile_errors.at(target.source)) + "\n"};
+            return;
         }
+
+        auto runs_dir = target.output + ".runs/";
+        auto overhead = sh::startup_overhead(target.output);
+        int timeout = 2 * timelimit / 1000.0 + std::ceil(overhead);
+        auto expected = tag_verdicts.at(tag);
+        bool hit = expected.empty();
+
+        fs::create_directory(runs_dir);
+
+        for (size_t j = 0; j < io_files.size(); ++j) {
+            auto [input, answer] = io_files[j];
+            auto output = runs_dir + std::to_string(j + 1);
+            auto info = sh::profile(target.output, "", timeout, input, output);
+            // The tags are checked against the raw running times, as judge does by default
+            auto ver = judge::evaluate(info, 0, timelimit, memory_limit, input, output, answer,
+                                       timeout);
+
+            rows[i][j] = verdict_letters.count(ver) ? verdict_letters.at(ver) : '?';
+
+            if (ver != judge::verdict::AC and not expected.count(ver)) {
+                failures[i] = {CP_TOOLS_ERROR_CHECK_SOLUTION_FAILED,
+                               message::failure("Solution '" + target.source +
+                                                "' is tagged as '" + tag + "', but got '" +
+                                                rows[i][j] + "' on test " +
+                                                std::to_string(j + 1)) +
+                                   "\n"};
+                return;
+            }
+
+            hit |= expected.count(ver) > 0;
+        }
+
+        if (not hit)
+            failures[i] = {CP_TOOLS_ERROR_CHECK_SOLUTION_FAILED,
+                           message::failure("Solution '" + target.source + "' is tagged as '" +
+                                            tag + "', but passed all tests") +
+                               "\n"};
+    };
+
+    // As on judge, a core is left free, so the running times don't depend on the machine load
+    parallel::for_each(solutions.size(), judge_solution,
+                       std::max<size_t>(1, parallel::max_workers() - 1));
+
+    size_t width = 8;
+
+    for (const auto &[tag, target] : solutions)
+        width = std::max(width, target.source.size());
+
+    table::Table matrix{{
+        {"Solution", width, format::align::LEFT | format::emph::BOLD},
+        {"Tag", 4, format::align::LEFT | format::emph::BOLD},
+        {"Tests", std::max<size_t>(5, io_files.size()), format::align::LEFT | format::emph::BOLD},
+        {"Result", 8, format::align::LEFT | format::emph::BOLD},
+    }};
+
+    for (size_t i = 0; i < solutions.size(); ++i) {
+        auto [tag, target] = solutions[i];
+        auto ok = failures[i].rc == CP_TOOLS_OK;
+
+        if (not tag_verdicts.count(tag)) {
+            out << message::warning("Unknown tag '" + tag + "' of '" + target.source +
+                                    "', skipped")
+                << '\n';
+            continue;
+        }
+
+        matrix.add_row({{target.source, format::align::LEFT},
+                        {tag, format::align::LEFT},
+                        {rows[i], format::align::LEFT},
+                        {ok ? "OK" : "Failed", ok ? format::style::AC : format::style::WA}});
     }
 
-    out << message::success() << '\n';
+    out << matrix << '\n';
 
-    return CP_TOOLS_OK;
+    return report_failures(failures, out, err, "solutions");
 }
 
-int validate_tests(std::ostream &out, std::ostream &err) {
+static int create_build_dir(std::ostream &out, std::ostream &err) {
     out << message::info("Creating directory " CP_TOOLS_BUILD_DIR);
     auto fs_res = fs::create_directory(CP_TOOLS_BUILD_DIR);
     if (not fs_res.ok) {
@@ -247,16 +531,79 @@ int validate_tests(std::ostream &out, std::ostream &err) {
         return fs_res.rc;
     }
 
+    return CP_TOOLS_OK;
+}
+
+static int build(std::ostream &out, std::ostream &err, int tools,
+                 const std::vector<build::Target> &extra) {
+    std::string error;
+    auto rc = task::build_targets(error, out, tools, extra);
+
+    if (rc != CP_TOOLS_OK) {
+        err << message::failure("Can't build the required tools") << '\n';
+        err << message::trace(error) << '\n';
+    }
+
+    return rc;
+}
+
+// Builds the tools, the default solution and the tagged ones at once. A tagged solution that
+// doesn't compile is only reported when the solutions are judged
+static int build_solutions(const nlohmann::json &config, std::ostream &out, std::ostream &err,
+                           int tools, std::map<std::string, std::string> &compile_errors) {
+    std::vector<build::Target> tagged;
+
+    for (const auto &solution : tagged_solutions(config))
+        tagged.push_back(solution.target);
+
+    fs::create_directory(std::string(CP_TOOLS_BUILD_DIR) + "/solutions");
+
+    std::string error;
+    auto rc = task::build_targets(error, out, tools, {task::solution_target()}, tagged,
+                                  compile_errors);
+
+    if (rc != CP_TOOLS_OK) {
+        err << message::failure("Can't build the required tools") << '\n';
+        err << message::trace(error) << '\n';
+    }
+
+    return rc;
+}
+
+int validate_checker(std::ostream &out, std::ostream &err) {
+    auto rc = create_build_dir(out, err);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
+    auto config = cptools::config::read_config_file();
+    auto solution = task::solution_target();
+
+    if (solution.source.empty()) {
+        err << "[validate_checker] Default solution file not found!\n";
+        return CP_TOOLS_ERROR_CHECK_MISSING_SOLUTION;
+    }
+
+    // The validator, the checker and the default solution are built concurrently
+    rc = build(out, err, task::tools::VALIDATOR | task::tools::CHECKER, {solution});
+
+    return rc == CP_TOOLS_OK ? test_checker(config, out, err) : rc;
+}
+
+int validate_validator(std::ostream &out, std::ostream &err) {
+    auto rc = create_build_dir(out, err);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
     auto program{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
     auto config = cptools::config::read_config_file();
     auto source = cptools::util::get_json_value(config, "tools|validator", std::string("ERROR"));
 
     if (source == "ERROR") {
-        err << message::failure("Default solution file not found!\n");
+        err << "[validate_validator] Default solution file not found!\n";
         return CP_TOOLS_ERROR_CHECK_MISSING_VALIDATOR;
     }
 
-    auto res = cptools::sh::build(program, source);
+    auto res = cptools::sh::build(program, source, config::get_compiler_profile(config));
 
     if (res.rc != CP_TOOLS_OK) {
         err << message::failure("Can't compile validator '" + source + "'!") << "\n";
@@ -264,29 +611,140 @@ int validate_tests(std::ostream &out, std::ostream &err) {
         return res.rc;
     }
 
+    return test_validator(config, out, err);
+}
+
+int validate_tests(std::ostream &out, std::ostream &err) {
+    auto rc = create_build_dir(out, err);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
+    auto config = cptools::config::read_config_file();
+
+    // Builds, at once, everything that generate_io_files() will need
+    rc = build(out, err, test_tools(config), {task::solution_target()});
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
     auto io_files = task::generate_io_files("all", out, err, false);
 
-    if (io_files.empty()) {
-        err << message::failure("There are no io files to validate!\n");
-        return CP_TOOLS_ERROR_CHECK_MISSING_IO_FILES;
-    }
+    return validate_inputs(io_files, out, err);
+}
 
-    out << message::info("Validating the input files (" + std::to_string(io_files.size()) +
-                         " tests) ...\n");
+int validate_solutions(std::ostream &out, std::ostream &err) {
+    auto rc = create_build_dir(out, err);
+    if (rc != CP_TOOLS_OK)
+        return rc;
 
-    for (auto [input, _] : io_files) {
-        auto result = sh::execute(program, "", input, "");
+    auto config = cptools::config::read_config_file();
+    std::map<std::string, std::string> compile_errors;
 
-        if (result.rc != CP_TOOLS_OK) {
-            err << message::failure("Input file '" + input + "' is invalid!\n");
-            err << message::trace(result.output) << '\n';
-            return CP_TOOLS_ERROR_CHECK_INVALID_INPUT_FILE;
-        }
+    rc = build_solutions(config, out, err, test_tools(config) | task::tools::CHECKER,
+                         compile_errors);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
+    auto io_files = task::generate_io_files("all", out, err);
+
+    return test_solutions(config, io_files, compile_errors, out, err);
+}
+
+// Everything is built at once, then the stages run concurrently, each one writing to its own
+// buffers, which are printed in order at the end. The solutions are judged last, on their own,
+// so their running times don't compete with the other stages
+int validate_all(std::ostream &out, std::ostream &err) {
+    auto rc = create_build_dir(out, err);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
+    auto config = cptools::config::read_config_file();
+    auto solution = task::solution_target();
+
+    if (solution.source.empty()) {
+        err << "[validate_all] Default solution file not found!\n";
+        return CP_TOOLS_ERROR_CHECK_MISSING_SOLUTION;
     }
 
-    out << message::success() << "\n";
+    std::map<std::string, std::string> compile_errors;
+
+    rc = build_solutions(config, out, err, test_tools(config) | task::tools::CHECKER,
+                         compile_errors);
+    if (rc != CP_TOOLS_OK)
+        return rc;
+
+    // The tests are generated once, by the first stage that needs them
+    std::once_flag generated;
+    std::ostringstream gen_out, gen_err;
+    std::vector<std::pair<std::string, std::string>> io_files;
+
+    auto tests = [&]() -> const std::vector<std::pair<std::string, std::string>> & {
+        std::call_once(generated,
+                       [&]() { io_files = task::generate_io_files("all", gen_out, gen_err); });
+        return io_files;
+    };
+
+    struct Stage {
+        std::string name;
+        std::function<int(std::ostream &, std::ostream &)> run;
+        std::ostringstream out, err;
+        int rc;
+        double elapsed;
+    };
+
+    std::vector<Stage> stages(4);
+
+    stages[0].name = "Validator";
+    stages[0].run = [&](std::ostream &o, std::ostream &e) { return test_validator(config, o, e); };
+    stages[1].name = "Checker";
+    stages[1].run = [&](std::ostream &o, std::ostream &e) { return test_checker(config, o, e); };
+    stages[2].name = "Tests";
+    stages[2].run = [&](std::ostream &o, std::ostream &e) {
+        return validate_inputs(tests(), o, e);
+    };
+    stages[3].name = "Solutions";
+    stages[3].run = [&](std::ostream &o, std::ostream &e) {
+        return test_solutions(config, tests(), compile_errors, o, e);
+    };
+
+    auto run_stage = [&](size_t i) {
+        auto start = std::chrono::steady_clock::now();
+
+        stages[i].rc = stages[i].run(stages[i].out, stages[i].err);
+        stages[i].elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    parallel::for_each(stages.size() - 1, run_stage, stages.size() - 1);
+    run_stage(stages.size() - 1);
+
+    out << gen_out.str();
+    err << gen_err.str();
+
+    table::Table summary{{
+        {"Stage", 12, format::align::LEFT | format::emph::BOLD},
+        {"Result", 8, format::align::LEFT | format::emph::BOLD},
+        {"Time (s)", 12, format::align::RIGHT | format::emph::BOLD},
+    }};
+
+    for (auto &stage : stages) {
+        out << stage.out.str();
+        err << stage.err.str();
+
+        char elapsed[64];
+        sprintf(elapsed, "%.3f", stage.elapsed);
+
+        summary.add_row({{stage.name, format::align::LEFT | format::emph::BOLD},
+                         stage.rc == CP_TOOLS_OK ? std::make_pair("OK", format::style::AC)
+                                                 : std::make_pair("Failed", format::style::WA),
+                         {elapsed, format::style::FLOAT}});
+
+        if (rc == CP_TOOLS_OK)
+            rc = stage.rc;
+    }
 
-    return CP_TOOLS_OK;
+    out << summary << '\n';
+
+    return rc;
 }
 
 // API functions
@@ -295,6 +753,9 @@ int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
 
     while ((option = getopt_long(argc, argv, "achstv", longopts, NULL)) != -1) {
         switch (option) {
+        case 'a':
+            return validate_all(out, err);
+
         case 'c':
             return validate_checker(out, err);
 
@@ -302,6 +763,9 @@ int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
             out << help() << '\n';
             return 0;
 
+        case 's':
+            return validate_solutions(out, err);
+
         case 't':
             return validate_tests(out, err);
 
@@ -314,6 +778,6 @@ int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
         }
     }
 
-    return CP_TOOLS_OK;
+    return validate_all(out, err);
 }
 } // namespace cptools::commands::check
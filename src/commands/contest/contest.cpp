@@ -0,0 +1,68 @@
+#include <getopt.h>
+#include <iostream>
+#include <unordered_map>
+
+#include "commands/contest/contest.h"
+#include "commands/contest/pdf.h"
+#include "defs.h"
+#include "error.h"
+
+// Raw strings
+static const std::string help_message{
+    R"message(
+Actions on a set of problems. The actions are:
+
+    Action          Description
+
+    pdf             Generates the booklets of the statements and of the tutorials.
+
+The options are:
+
+    Option          Description
+
+    -h              Generates this help message.
+    --help
+
+)message"};
+
+namespace cptools::commands::contest {
+
+// Global variables
+std::unordered_map<std::string, int (*)(int, char *const[], std::ostream &, std::ostream &)>
+    commands{{"pdf", pdf::run}};
+
+static struct option longopts[] = {{"help", no_argument, NULL, 'h'}, {0, 0, 0, 0}};
+
+// Auxiliary routines
+std::string usage() { return "Usage: " NAME " contest [-h] action"; }
+
+std::string help() { return usage() + help_message; }
+
+// API functions
+int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
+    int option = -1;
+
+    if (argc >= 3) {
+        std::string command{argv[2]};
+        auto it = commands.find(command);
+        if (it != commands.end())
+            return commands[command](argc, argv, out, err);
+    }
+
+    while ((option = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        switch (option) {
+        case 'h':
+            out << help() << '\n';
+            return CP_TOOLS_OK;
+
+        default:
+            err << help() << '\n';
+            return CP_TOOLS_ERROR_CONTEST_INVALID_OPTION;
+        }
+    }
+
+    err << help() << '\n';
+    return CP_TOOLS_ERROR_INVALID_COMMAND;
+}
+
+} // namespace cptools::commands::contest
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <getopt.h>
+#include <sstream>
+#include <vector>
+
+#include "commands/contest/pdf.h"
+#include "commands/gentex.h"
+#include "defs.h"
+#include "dirs.h"
+#include "error.h"
+#include "fs.h"
+#include "latex.h"
+#include "message.h"
+#include "parallel.h"
+#include "sh.h"
+
+namespace cptools::commands::contest::pdf {
+
+// Static variables
+static const std::string help_message{
+    R"message(
+Generates the PDF files of the statements and of the tutorials of the given problems, for each
+language, and merges them into the booklets 'contest-<lang>.pdf' and 'tutorials-<lang>.pdf'.
+The problems are labeled in the given order (A, B, C, ...) and all of them are built concurrently.
+A problem that fails is reported and left out of the booklets.
+The options are:
+
+    Option          Description
+
+    -c              Document class that will be used. The default value
+    --class         is 'cp_modern'.
+
+    -g              Language of the booklets. It can be used many times. The
+    --lang          default value is 'pt_BR'.
+
+    -h              Generates this help message.
+    --help
+
+    -o              Directory of the booklets. The default value is the
+    --output        current directory.
+
+    --no_tutorial   Generates only the booklet of the statements.
+
+)message"};
+
+typedef enum { NO_TUTORIAL = 1000 } Value;
+
+static struct option longopts[] = {{"help", no_argument, NULL, 'h'},
+                                   {"class", required_argument, NULL, 'c'},
+                                   {"lang", required_argument, NULL, 'g'},
+                                   {"output", required_argument, NULL, 'o'},
+                                   {"no_tutorial", no_argument, NULL, NO_TUTORIAL},
+                                   {0, 0, 0, 0}};
+
+// A statement or a tutorial of a problem, in one language
+struct Variant {
+    size_t problem;
+    std::string language;
+    bool tutorial;
+    std::string pdf;
+    sh::Result result;
+};
+
+// Functions
+std::string usage() {
+    return "Usage: " NAME " contest pdf [-h] [-c doc_class] [-g lang] [-o dir] [--no_tutorial] "
+           "problem_dir...";
+}
+
+std::string help() { return usage() + help_message; }
+
+std::string label(size_t index) {
+    std::string s;
+
+    for (++index; index > 0; index = (index - 1) / 26)
+        s.insert(s.begin(), 'A' + (index - 1) % 26);
+
+    return s;
+}
+
+// Quotes a word for the shell: each single quote ends the quoting, is escaped and starts it again
+static std::string quote(const std::string &s) {
+    std::string quoted{"'"};
+
+    for (auto c : s)
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+
+    return quoted + "'";
+}
+
+// The variants are built by other processes of this very program, so each one has its own
+// working directory (the problem's) and its own copy of the getopt state
+static std::string self_path() {
+    std::error_code ec;
+    auto path = std::filesystem::read_symlink("/proc/self/exe", ec);
+
+    return ec ? std::string(NAME) : path.string();
+}
+
+static sh::Result build_variant(const std::string &self, const std::string &dir,
+                                const std::string &doc_class, const std::string &problem_label,
+                                const Variant &variant) {
+    // The option -t sets the default output file, so it must come before -o
+    std::string args{std::string("genpdf") + (variant.tutorial ? " -t" : "") + " -b " +
+                     problem_label + " -c " + quote(doc_class) + " -g " + variant.language +
+                     " -o " + quote(variant.pdf)};
+
+    // A stale PDF of an earlier run must not be merged if this one fails
+    fs::remove(variant.pdf);
+
+    return sh::execute("cd " + quote(dir) + " && " + quote(self), args, "", "", 0);
+}
+
+// Merges the PDF files, in order, with the package pdfpages
+static sh::Result build_booklet(const std::string &pdf, const std::string &texfile,
+                                const std::vector<std::string> &parts) {
+    std::ostringstream tex;
+
+    tex << "\\documentclass{article}\n\n";
+    tex << "\\usepackage{pdfpages}\n\n";
+    tex << "\\begin{document}\n\n";
+
+    for (const auto &part : parts)
+        tex << "\\includepdf[pages=-]{" << part << "}\n";
+
+    tex << "\n\\end{document}\n";
+
+    if (not fs::is_file(texfile).ok or fs::read_file(texfile) != tex.str())
+        fs::overwrite_file(texfile, tex.str());
+
+    bool rebuilt;
+
+    return latex::build(pdf, texfile, "article", rebuilt);
+}
+
+static int generate_booklets(const std::vector<std::string> &problems,
+                             const std::vector<std::string> &languages,
+                             const std::string &doc_class, const std::string &outdir,
+                             bool tutorials, std::ostream &out, std::ostream &err) {
+    std::string build_dir{std::string(CP_TOOLS_BUILD_DIR) + "/contest"};
+
+    std::vector<std::string> dirs{CP_TOOLS_BUILD_DIR, build_dir, outdir};
+
+    for (const auto &language : languages)
+        dirs.push_back(build_dir + "/" + language);
+
+    for (const auto &dir : dirs) {
+        auto res = fs::create_directory(dir);
+
+        if (not res.ok) {
+            err << message::failure(res.error_message) << '\n';
+            return res.rc;
+        }
+    }
+
+    std::vector<Variant> variants;
+
+    for (size_t i = 0; i < problems.size(); ++i)
+        for (const auto &language : languages)
+            for (auto tutorial : {false, true}) {
+                if (tutorial and not tutorials)
+                    continue;
+
+                auto name = label(i) + (tutorial ? "-tutorial" : "") + ".pdf";
+                auto pdf = std::filesystem::absolute(build_dir + "/" + language + "/" + name);
+
+                variants.push_back({i, language, tutorial, pdf.string(), {CP_TOOLS_OK, ""}});
+            }
+
+    auto self = self_path();
+
+    parallel::for_each(variants.size(), [&](size_t i) {
+        auto &variant = variants[i];
+
+        variant.result = build_variant(self, problems[variant.problem], doc_class,
+                                       label(variant.problem), variant);
+    });
+
+    // The failures are reported by problem, and the other problems go on to the booklets
+    auto rc = CP_TOOLS_OK;
+
+    for (size_t i = 0; i < problems.size(); ++i) {
+        auto failed = false;
+
+        for (const auto &variant : variants) {
+            if (variant.problem != i or variant.result.rc == CP_TOOLS_OK)
+                continue;
+
+            err << message::failure("Problem " + label(i) + " ('" + problems[i] + "'): can't " +
+                                    "generate the " +
+                                    (variant.tutorial ? "tutorial" : "statement") + " in " +
+                                    variant.language)
+                << '\n';
+            err << message::trace(variant.result.output) << '\n';
+
+            failed = true;
+        }
+
+        if (failed)
+            rc = CP_TOOLS_ERROR_CONTEST_PROBLEM_FAILED;
+        else
+            out << message::info("Problem " + label(i) + ": '" + problems[i] + "'") << '\n';
+    }
+
+    for (const auto &language : languages)
+        for (auto tutorial : {false, true}) {
+            if (tutorial and not tutorials)
+                continue;
+
+            std::string kind{tutorial ? "tutorials" : "contest"};
+            std::vector<std::string> parts;
+
+            for (const auto &variant : variants)
+                if (variant.language == language and variant.tutorial == tutorial and
+                    variant.result.rc == CP_TOOLS_OK)
+                    parts.push_back(std::filesystem::relative(variant.pdf).string());
+
+            if (parts.empty()) {
+                out << message::warning("No problem on the " + kind + " booklet in " + language)
+                    << '\n';
+                continue;
+            }
+
+            auto pdf = build_dir + "/" + language + "/" + kind + ".pdf";
+            auto res = build_booklet(pdf, build_dir + "/" + language + "/" + kind + ".tex", parts);
+
+            if (res.rc != CP_TOOLS_OK) {
+                err << message::failure("Error generating the PDF file '" + pdf + "'!") << '\n';
+                err << message::trace(res.output) << '\n';
+                rc = CP_TOOLS_ERROR_CONTEST_BOOKLET_FAILED;
+                continue;
+            }
+
+            auto outfile = outdir + "/" + kind + "-" + language + ".pdf";
+            auto copy_res = fs::copy(pdf, outfile, true);
+
+            if (not copy_res.ok) {
+                err << message::failure(copy_res.error_message) << '\n';
+                rc = copy_res.rc;
+                continue;
+            }
+
+            out << message::success("File '" + outfile + "' generated (" +
+                                    std::to_string(parts.size()) + " of " +
+                                    std::to_string(problems.size()) + " problems).")
+                << '\n';
+        }
+
+    return rc;
+}
+
+// API
+int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
+    int option = -1;
+    bool tutorials = true;
+
+    std::string document_class{"cp_modern"}, outdir{"."};
+    std::vector<std::string> languages;
+
+    while ((option = getopt_long(argc, argv, "hc:g:o:", longopts, NULL)) != -1) {
+        switch (option) {
+        case 'h':
+            out << help() << '\n';
+            return CP_TOOLS_OK;
+
+        case 'c':
+            document_class = std::string(optarg);
+            break;
+
+        case 'g': {
+            std::string language{optarg};
+
+            if (not gentex::validate_language(language)) {
+                err << message::failure("Language '" + language + "' not find or supported\n");
+                return CP_TOOLS_ERROR_CONTEST_INVALID_LANGUAGE;
+            }
+
+            if (std::find(languages.begin(), languages.end(), language) == languages.end())
+                languages.push_back(language);
+
+            break;
+        }
+
+        case 'o':
+            outdir = std::string(optarg);
+            break;
+
+        case NO_TUTORIAL:
+            tutorials = false;
+            break;
+
+        default:
+            err << help() << '\n';
+            return CP_TOOLS_ERROR_CONTEST_INVALID_OPTION;
+        }
+    }
+
+    // The first non-option arguments are the words 'contest' and 'pdf'
+    if (optind + 2 >= argc) {
+        err << help() << '\n';
+        return CP_TOOLS_ERROR_CONTEST_MISSING_PROBLEMS;
+    }
+
+    std::vector<std::string> problems(argv + optind + 2, argv + argc);
+
+    if (languages.empty())
+        languages.push_back("pt_BR");
+
+    return generate_booklets(problems, languages, document_class, outdir, tutorials, out, err);
+}
+
+} // namespace cptools::commands::contest::pdf
@@ -8,6 +8,7 @@
 
 #include "commands/check.h"
 #include "commands/clean.h"
+#include "commands/contest/contest.h"
 #include "commands/cptools.h"
 #include "commands/genpdf.h"
 #include "commands/gentex.h"
@@ -25,6 +26,7 @@ Format, test and pack competitive programming problems.
     init                Generates template files on current directory.
     check               Verifies problem files and tools.
     clean               Removes autogenerated files.
+    contest             Generates the booklets of a set of problems.
     genpdf              Generates a PDF file from the problem description. 
     gentex              Generates a LaTeX file from the problem description. 
     judge               Runs a solution against all tests sets.
@@ -47,7 +49,7 @@ std::unordered_map<std::string, int (*)(int, char *const[], std::ostream &, std:
     commands{
         {"init", init::run},       {"check", check::run},   {"clean", clean::run},
         {"gentex", gentex::run},   {"genpdf", genpdf::run}, {"judge", judge::run},
-        {"polygon", polygon::run},
+        {"polygon", polygon::run}, {"contest", contest::run},
     };
 
 static struct option longopts[] = {
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <getopt.h>
 #include <iostream>
+#include <sstream>
 #include <unistd.h>
 
 #include "commands/gentex.h"
@@ -11,6 +12,7 @@
 #include "dirs.h"
 #include "error.h"
 #include "fs.h"
+#include "latex.h"
 #include "message.h"
 #include "sh.h"
 #include "task.h"
@@ -75,43 +77,45 @@ std::string help() { return usage() + help_message; }
 int generate_pdf(const std::string &doc_class, const std::string &language, int flags,
                  const std::string &label, const std::string &outfile, bool tutorial,
                  std::ostream &out, std::ostream &err) {
-    auto fs_res = fs::create_directory(CP_TOOLS_BUILD_DIR);
-    if (not fs_res.ok) {
-        err << message::failure(fs_res.error_message);
-        return fs_res.rc;
-    }
-
-    // Generates the tex file that will be used to build the pdf file
-    std::string texfile_path{std::string(CP_TOOLS_BUILD_DIR) +
-                             (tutorial ? "/tutorial.tex" : "/problem.tex")};
-    auto removed_result = fs::remove(texfile_path);
-    if (not removed_result.ok) {
-        err << message::failure(removed_result.error_message);
-        return removed_result.rc;
+    // Each language is built on its own directory, so they can be built concurrently
+    std::string build_dir{std::string(CP_TOOLS_BUILD_DIR) + "/pdf/" + language};
+
+    for (auto dir : {std::string(CP_TOOLS_BUILD_DIR), std::string(CP_TOOLS_BUILD_DIR) + "/pdf",
+                     build_dir}) {
+        auto fs_res = fs::create_directory(dir);
+        if (not fs_res.ok) {
+            err << message::failure(fs_res.error_message);
+            return fs_res.rc;
+        }
     }
 
-    std::ofstream tex_file(texfile_path);
-
-    if (not tex_file) {
-        err << message::failure("Error opening file '" + texfile_path) << "'\n";
-        return CP_TOOLS_ERROR_GENPDF_INVALID_OUTFILE;
-    }
+    // Generates the tex file that will be used to build the pdf file. It is only written when
+    // its contents change, so the PDF is kept when nothing else changed either
+    std::string texfile_path{build_dir + (tutorial ? "/tutorial.tex" : "/problem.tex")};
+    std::ostringstream tex;
 
     auto task = tutorial ? gentex::generate_tutorial_latex : gentex::generate_latex;
-    auto rc = task(doc_class, language, flags, label, tex_file, err);
+    auto rc = task(doc_class, language, flags, label, tex, err);
 
     if (rc != CP_TOOLS_OK) {
         err << message::failure("Error generating the LaTeX file '" + texfile_path) << "'\n";
         return rc;
     }
 
-    tex_file.close();
+    if (not fs::is_file(texfile_path).ok or fs::read_file(texfile_path) != tex.str()) {
+        std::ofstream tex_file(texfile_path);
 
-    // Generates the PDF file 'problem.pdf' on CP_TOOLS_BUILD_DIR
-    std::string pdf_file{std::string(CP_TOOLS_BUILD_DIR) +
-                         (tutorial ? "/tutorial.pdf" : "/problem.pdf")};
+        if (not(tex_file << tex.str())) {
+            err << message::failure("Error opening file '" + texfile_path) << "'\n";
+            return CP_TOOLS_ERROR_GENPDF_INVALID_OUTFILE;
+        }
+    }
 
-    auto res = sh::build(pdf_file, texfile_path);
+    // Generates the PDF file 'problem.pdf' on the build directory of the language
+    std::string pdf_file{build_dir + (tutorial ? "/tutorial.pdf" : "/problem.pdf")};
+
+    bool rebuilt;
+    auto res = latex::build(pdf_file, texfile_path, doc_class, rebuilt);
 
     if (res.rc != CP_TOOLS_OK) {
         err << message::failure("Error generating the PDF file '" + pdf_file + "'!") << "\n";
@@ -119,6 +123,13 @@ int generate_pdf(const std::string &doc_class, const std::string &language, int
         return res.rc;
     }
 
+    if (rebuilt)
+        out << message::info("Built '" + pdf_file + "' (pdflatex passes: " +
+                             std::to_string(sh::tex_passes(pdf_file)) + ")")
+            << '\n';
+    else
+        out << message::info("The sources of '" + pdf_file + "' didn't change") << '\n';
+
     // Copy the generated PDF to the output file
     auto copy_res = fs::copy(pdf_file, outfile, true);
     if (not copy_res.ok) {
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include <dirent.h>
 #include <getopt.h>
@@ -146,6 +147,14 @@ int list_document_classes(std::ostream &out, std::ostream &err) {
     return CP_TOOLS_OK;
 }
 
+// The class, up to the mark, is preloaded from a TeX format shared by the problems (see
+// sh::build_tex), and the rest of the preamble is read on each build
+static void write_document_class(const std::string &doc_class, const std::string &lang,
+                                 std::ostream &out) {
+    out << "\\documentclass[" << lang << "]{" << doc_class << "}\n";
+    out << "\\csname endofdump\\endcsname\n\n";
+}
+
 int generate_tutorial_latex(const std::string &doc_class, const std::string &language, int flags,
                             const std::string &label, std::ostream &out, std::ostream &) {
     auto config = config::read_config_file();
@@ -163,7 +172,7 @@ int generate_tutorial_latex(const std::string &doc_class, const std::string &lan
         (not util::get_json_value(config, "PDF|include_author", false)))
         author = "";
 
-    out << "\\documentclass[" << lang << "]{" << doc_class << "}\n\n";
+    write_document_class(doc_class, lang, out);
     out << "\\usepackage{amsmath}\n";
     out << "\\usepackage{tikz}\n\n";
 
@@ -210,7 +219,7 @@ int generate_latex(const std::string &doc_class, const std::string &language, in
         (not util::get_json_value(config, "PDF|include_author", false)))
         author = "";
 
-    out << "\\documentclass[" << lang << "]{" << doc_class << "}\n\n";
+    write_document_class(doc_class, lang, out);
     out << "\\begin{document}\n\n";
 
     out << "\\header{" << event << "}{" << author << "}\n\n";
@@ -226,7 +235,7 @@ int generate_latex(const std::string &doc_class, const std::string &language, in
 
     out << "\\begin{samples}{" << c1_size << "}{" << c2_size << "}\n";
 
-    auto io_files = task::generate_io_files("samples", out, err);
+    auto io_files = task::sample_files(err);
 
     for (auto [infile, outfile] : io_files)
         out << "    \\iosample{" << c1_size << "}{" << c2_size << "}{" << infile << "}{" << outfile
@@ -40,8 +40,8 @@ std::string help() { return usage() + help_message; }
 int copy_template_files(const std::string &dest, std::ostream &out, std::ostream &err) {
     out << message::info("Initializing directory '" + dest + "' ...") << "\n";
 
-    // Copy templates to the directory
-    auto res = cptools::fs::copy(CP_TOOLS_TEMPLATES_DIR, dest, true);
+    // Copy templates to the directory. The files will be edited, so they can't be hard links
+    auto res = cptools::fs::materialize(CP_TOOLS_TEMPLATES_DIR, dest);
     if (not res.ok)
         err << message::failure(res.error_message) << "\n";
     else
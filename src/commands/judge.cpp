@@ -1,17 +1,24 @@
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <map>
+#include <vector>
 
 #include <getopt.h>
 #include <unistd.h>
 
 #include "commands/clean.h"
 #include "commands/judge.h"
+#include "compress.h"
 #include "config.h"
 #include "defs.h"
 #include "dirs.h"
 #include "error.h"
+#include "forkserver.h"
 #include "format.h"
+#include "fs.h"
 #include "message.h"
+#include "parallel.h"
 #include "sh.h"
 #include "table.h"
 #include "task.h"
@@ -27,6 +34,27 @@ Runs a solution against all test sets and gives you a veredict.
     -h              Generates this help message.
     --help
 
+    -x              Stops on the first test that is not accepted. The remaining tests are
+    --fail-fast     neither generated nor judged.
+
+    -u              Judges each distinct input once. Tests that repeat the input of a
+    --unique        previous test are reported with the results of that test.
+
+    -p              Builds the solution with the given compiler profile, instead of the
+    --profile       problem's one.
+
+    -f              Runs a C/C++ solution in fork-server mode: each test is forked from a
+    --fork-server   snapshot of the solution taken right before main(), which skips the
+                    process startup on every test.
+
+    -s              Builds the solution with AddressSanitizer and UndefinedBehaviorSanitizer
+    --sanitize      and runs the tests in parallel, with scaled time and memory limits.
+
+    -t              Subtracts the startup time of the runtime (the JVM or the Python
+    --subtract-startup
+                    interpreter), measured at build time, from the running time of each
+                    test. By default the verdicts are given by the raw running times.
+
 )message"};
 
 namespace cptools::commands::judge {
@@ -45,7 +73,14 @@ const int FAIL = 8;
 } // namespace verdict
 
 // Global variables
-static struct option longopts[] = {{"help", no_argument, NULL, 'h'}, {0, 0, 0, 0}};
+static struct option longopts[] = {{"help", no_argument, NULL, 'h'},
+                                   {"fork-server", no_argument, NULL, 'f'},
+                                   {"fail-fast", no_argument, NULL, 'x'},
+                                   {"unique", no_argument, NULL, 'u'},
+                                   {"profile", required_argument, NULL, 'p'},
+                                   {"sanitize", no_argument, NULL, 's'},
+                                   {"subtract-startup", no_argument, NULL, 't'},
+                                   {0, 0, 0, 0}};
 
 std::map<int, std::string> ver_string{
     {verdict::AC, "Accepted"},
@@ -68,11 +103,98 @@ const std::map<int, long long> ver_style{
 };
 
 // Auxiliary routines
-std::string usage() { return "Usage: " NAME " problem judge solution.[cpp|c|java|py]"; }
+std::string usage() {
+    return "Usage: " NAME
+           " judge [-h] [-x] [-u] [-t] [-p profile] [-f|-s] solution.[cpp|c|java|py]";
+}
 
 std::string help() { return usage() + help_message; }
 
-int judge(const std::string &solution_path, std::ostream &out, std::ostream &err) {
+// Sanitized builds are slower and use more memory, so their limits are scaled up
+namespace sanitizer {
+const std::vector<std::string> flags{"-fsanitize=address,undefined", "-fno-sanitize-recover=all",
+                                     "-fno-omit-frame-pointer", "-g"};
+const std::vector<std::string> link{"-fsanitize=address,undefined"};
+
+// Most solutions never free their memory, so leaks are not reported
+const std::string env{"env ASAN_OPTIONS=detect_leaks=0 UBSAN_OPTIONS=print_stacktrace=1 "};
+
+constexpr double TIME_FACTOR = 3.0;
+constexpr double MEMORY_FACTOR = 3.0;
+} // namespace sanitizer
+
+static sh::Profile sanitized(sh::Profile profile) {
+    for (auto lang : {"c", "cpp"}) {
+        auto &compiler = profile[lang];
+
+        compiler.flags.insert(compiler.flags.end(), sanitizer::flags.begin(),
+                              sanitizer::flags.end());
+        compiler.link.insert(compiler.link.end(), sanitizer::link.begin(), sanitizer::link.end());
+    }
+
+    return profile;
+}
+
+struct Execution {
+    bool valid;
+    bool judged; // False for tests skipped after a failure, on fail-fast runs
+    int verdict;
+    sh::Info info;
+    std::string log;
+};
+
+static int check_output(const std::string &checker, const std::string &input,
+                        const std::string &output, const std::string &answer, int timeout) {
+    auto args{input + " " + output + " " + answer};
+    auto res = sh::execute(checker, args, "", "/dev/null", timeout);
+
+    switch (res.rc) {
+    case 6:
+        return verdict::WA;
+
+    case 5:
+        return verdict::PE;
+
+    case 4:
+        return verdict::AC;
+
+    default:
+        return verdict::UNDEF;
+    };
+}
+
+int evaluate(sh::Info &info, double overhead, double timelimit, double memory_limit,
+             const std::string &input, const std::string &output, const std::string &answer,
+             int timeout) {
+    auto checker{std::string(CP_TOOLS_BUILD_DIR) + "/checker"};
+
+    info.elapsed = std::max(0.0, info.elapsed - overhead);
+
+    if (info.memory > memory_limit)
+        return verdict::MLE;
+
+    if (info.elapsed > timelimit / 1000.0)
+        return verdict::TLE;
+
+    if (info.rc != CP_TOOLS_OK)
+        return verdict::RTE;
+
+    if (not compress::is_compressed(answer))
+        return check_output(checker, input, output, answer, timeout);
+
+    // The checker reads plain files, so the answer is decompressed just for this run
+    auto plain = output + ".ans";
+    auto res = compress::decompress(answer, plain);
+    auto ver = res.ok ? check_output(checker, input, output, plain, timeout) : verdict::FAIL;
+
+    fs::remove(plain);
+
+    return ver;
+}
+
+int judge(const std::string &solution_path, const std::string &profile_name, bool sanitize,
+          bool fork_server, bool fail_fast, bool unique, bool subtract_startup, std::ostream &out,
+          std::ostream &err) {
     table::Table report{{
         {"#", 4, format::align::RIGHT | format::emph::BOLD},
         {"Verdict", 32, format::align::LEFT | format::emph::BOLD},
@@ -82,36 +204,108 @@ int judge(const std::string &solution_path, std::ostream &out, std::ostream &err
 
     out << message::info("Judging solution '" + solution_path + "'...") << "\n";
 
-    // Constrói as ferramentas necessárias
+    auto config = cptools::config::read_config_file();
+    double timelimit = cptools::util::get_json_value(config, "problem|timelimit", 1000);
+    double memory_limit = cptools::util::get_json_value(config, "problem|memory_limit", 1000);
+
+    // The option -p overrides the profile assigned to the solution in the config file
+    auto name = profile_name.empty() ? config::get_solution_profile_name(config, solution_path)
+                                     : profile_name;
+
+    if (not name.empty() and
+        util::get_json_value(config, "compilers|profiles|" + name, nlohmann::json()).is_null()) {
+        err << message::failure("Compiler profile '" + name + "' not found") << '\n';
+        return CP_TOOLS_ERROR_JUDGE_INVALID_PROFILE;
+    }
+
+    auto profile = config::get_compiler_profile(config, name);
+    auto program{std::string(CP_TOOLS_BUILD_DIR) + "/sol"};
+
+    // The sanitized binary has its own slot, so it never replaces the regular one
+    if (sanitize) {
+        profile = sanitized(profile);
+        program += "-sanitize";
+
+        timelimit *= util::get_json_value(config, "compilers|sanitizer|time_factor",
+                                          sanitizer::TIME_FACTOR);
+        memory_limit *= util::get_json_value(config, "compilers|sanitizer|memory_factor",
+                                             sanitizer::MEMORY_FACTOR);
+
+        out << message::warning("Sanitizers enabled: time limit = " +
+                                std::to_string((int)timelimit) +
+                                " ms, memory limit = " + std::to_string((int)memory_limit) +
+                                " MB")
+            << '\n';
+    }
+
+    std::string mode{sanitize ? "sanitized" : "exec"};
+    auto ext = util::split(solution_path, '.').back();
+
+    // Only native programs can be forked from a snapshot
+    if (fork_server and (ext == "c" or ext == "cpp")) {
+        fs::create_directory(CP_TOOLS_BUILD_DIR);
+        auto link = forkserver::link_options(CP_TOOLS_BUILD_DIR);
+
+        if (link.empty())
+            out << message::warning("Can't build the fork-server stub, running with exec") << '\n';
+        else {
+            for (auto lang : {"c", "cpp"})
+                profile[lang].link.insert(profile[lang].link.end(), link.begin(), link.end());
+
+            program += "-forkserver";
+            mode = "fork-server";
+        }
+    } else if (fork_server)
+        out << message::warning("Fork-server mode is only available for C/C++ solutions") << '\n';
+
+    // The solution is always rebuilt
+    auto fs_res = fs::remove(program);
+    if (not fs_res.ok) {
+        err << message::failure(fs_res.error_message) << '\n';
+        return fs_res.rc;
+    }
+
+    // Constrói as ferramentas necessárias, a solução e a solução padrão ao mesmo tempo
+    int tools = task::tools::VALIDATOR | task::tools::CHECKER;
+
+    if (task::has_random_tests(config) and
+        not util::get_json_value(config, "tools|generator", std::string()).empty())
+        tools |= task::tools::GENERATOR;
+
     std::string error;
-    auto rc = task::build_tools(error, task::tools::VALIDATOR | task::tools::CHECKER);
+    auto rc = task::build_targets(error, out, tools,
+                                  {{program, solution_path, profile}, task::solution_target()});
 
     if (rc != CP_TOOLS_OK) {
+        if (not fs::is_file(program).ok) {
+            err << message::failure("Error on solution '" + solution_path + "' compilation")
+                << '\n';
+            err << message::trace(error) << '\n';
+            return verdict::CE;
+        }
+
         err << message::failure("Can't build the required tools") << '\n';
         err << message::trace(error);
         return CP_TOOLS_ERROR_JUDGE_MISSING_TOOL;
     }
 
-    // Gera o executável da solução
-    rc = task::gen_exe(error, solution_path, "sol");
+    auto validator{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
+    auto runs_dir{std::string(CP_TOOLS_BUILD_DIR) + "/runs/"};
 
-    if (rc != CP_TOOLS_OK) {
-        err << message::failure("Error on solution '" + solution_path + "' compilation") << '\n';
-        err << message::trace(error) << '\n';
-        return verdict::CE;
+    fs_res = fs::create_directory(runs_dir);
+    if (not fs_res.ok) {
+        err << message::failure(fs_res.error_message) << '\n';
+        return fs_res.rc;
     }
 
-    auto config = cptools::config::read_config_file();
-    auto timelimit = cptools::util::get_json_value(config, "problem|timelimit", 1000);
-    auto memory_limit = cptools::util::get_json_value(config, "problem|memory_limit", 1000);
-
-    auto checker{std::string(CP_TOOLS_BUILD_DIR) + "/checker"};
-    auto program{std::string(CP_TOOLS_BUILD_DIR) + "/sol"};
-    auto validator{std::string(CP_TOOLS_BUILD_DIR) + "/validator"};
+    // The runtime startup (e.g. the JVM) is always reported, but it is charged to the solution
+    // unless asked otherwise, so the verdicts match a judge that doesn't subtract it
+    auto overhead = sh::startup_overhead(program);
+    auto subtracted = subtract_startup ? overhead : 0.0;
 
-    auto files = task::generate_io_files("all", out, err);
     int ans = verdict::AC, passed = 0;
     double tmax = 0.0, mmax = 0.0;
+    int timeout = 2 * timelimit / 1000.0 + std::ceil(overhead);
 
     auto as_string = [](double x, int places) {
         char buffer[64];
@@ -120,56 +314,118 @@ int judge(const std::string &solution_path, std::ostream &out, std::ostream &err
         return std::string(buffer);
     };
 
-    for (auto [input, answer] : files) {
+    // Each test has its own output file, so they can be run at the same time
+    std::vector<std::pair<std::string, std::string>> files;
+    std::vector<Execution> executions;
+    std::vector<size_t> originals; // First test with the same input
+    forkserver::Server server{-1, -1};
+
+    if (mode == "fork-server" and not forkserver::start(server, program)) {
+        out << message::warning("The solution didn't start in fork-server mode, running with exec")
+            << '\n';
+        mode = "exec";
+    }
+
+    std::atomic<bool> invalid{false}, stop{false};
+
+    auto run_test = [&](size_t i) {
+        auto [input, answer] = files[i];
         auto number = util::split(input, '/').back();
-        auto output{std::string(CP_TOOLS_BUILD_DIR) + "/out"};
+        auto output{runs_dir + number};
+        auto &execution = executions[i];
+
+        execution.valid = not invalid;
+        execution.judged = false;
+
+        if (invalid or stop)
+            return;
 
         auto res = sh::execute(validator, "", input);
 
         if (res.rc != CP_TOOLS_OK) {
-            err << message::failure("Input file '" + input + "' is invalid") << "\n";
-            err << message::trace(res.output) << '\n';
-            return CP_TOOLS_ERROR_JUDGE_INVALID_INPUT_FILE;
+            execution.valid = false;
+            execution.log = res.output;
+            invalid = true;
+            return;
         }
 
-        auto info = sh::profile(program, "", 2 * timelimit / 1000.0, input, output);
+        auto log = sanitize ? output + ".log" : "";
+        auto info = server.pid > 0 ? forkserver::run(server, input, output, timeout)
+                                   : sh::profile((sanitize ? sanitizer::env : "") + program, "",
+                                                 timeout, input, output, log);
 
-        int ver = verdict::AC;
+        auto ver = evaluate(info, subtracted, timelimit, memory_limit, input, output, answer,
+                            timeout);
 
-        if (info.rc != CP_TOOLS_OK)
-            ver = verdict::RTE;
+        if (ver == verdict::RTE and sanitize)
+            execution.log = fs::read_file(log);
 
-        if (info.elapsed > timelimit / 1000.0) {
-            ver = verdict::TLE;
-        }
+        execution.judged = true;
+        execution.verdict = ver;
+        execution.info = info;
+
+        if (fail_fast and ver != verdict::AC)
+            stop = true;
+    };
+
+    // Regular runs judge each test as soon as it is generated, while the next ones are made on
+    // the other cores. Sanitized runs are slow, so the tests are spread across all cores
+    auto workers = sanitize ? 0 : std::max<size_t>(1, parallel::max_workers() - 1);
 
-        if (info.memory > memory_limit)
-            ver = verdict::MLE;
+    rc = task::stream_io_files(
+        "all", out, err,
+        [&](size_t i, size_t original, const std::string &input, const std::string &answer) {
+            files.emplace_back(input, answer);
+            executions.emplace_back();
+            originals.push_back(unique ? original : i);
 
-        if (ver == verdict::AC) {
-            auto args{input + " " + output + " " + answer};
+            if (not sanitize and originals[i] == i)
+                run_test(i);
 
-            res = sh::execute(checker, args, "", "/dev/null", 2 * timelimit / 1000.0);
+            return not invalid and not stop;
+        },
+        true, workers);
 
-            switch (res.rc) {
-            case 6:
-                ver = verdict::WA;
-                break;
+    if (sanitize)
+        parallel::for_each(files.size(), [&](size_t i) {
+            if (originals[i] == i)
+                run_test(i);
+        });
 
-            case 5:
-                ver = verdict::PE;
-                break;
+    // Repeated inputs take the results of their first test
+    size_t judged = 0;
 
-            case 4:
-                ver = verdict::AC;
-                break;
+    for (size_t i = 0; i < files.size(); ++i) {
+        judged += originals[i] == i and executions[i].judged;
+        executions[i] = executions[originals[i]];
+    }
 
-            default:
-                ver = verdict::UNDEF;
-                break;
-            };
+    forkserver::stop(server);
+
+    if (rc != CP_TOOLS_OK) {
+        err << message::failure("Can't generate the tests") << '\n';
+        return rc;
+    }
+
+    std::string sanitizer_log;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto input = files[i].first;
+        auto number = util::split(input, '/').back();
+        auto [valid, judged, ver, info, log] = executions[i];
+
+        if (not valid) {
+            err << message::failure("Input file '" + input + "' is invalid") << "\n";
+            err << message::trace(log) << '\n';
+            return CP_TOOLS_ERROR_JUDGE_INVALID_INPUT_FILE;
         }
 
+        if (not judged)
+            continue;
+
+        if (sanitizer_log.empty() and not log.empty())
+            sanitizer_log = "Test " + number + ":\n" + log;
+
         ans = std::max(ans, ver);
         tmax = std::max(tmax, info.elapsed);
         mmax = std::max(mmax, info.memory);
@@ -183,8 +439,17 @@ int judge(const std::string &solution_path, std::ostream &out, std::ostream &err
 
     out << report << '\n';
 
+    if (stop)
+        out << message::warning("Fail-fast: the remaining tests were skipped") << '\n';
+
+    if (not sanitizer_log.empty())
+        out << message::trace(sanitizer_log) << '\n';
+
     int col_size = 12;
 
+    out << format::apply("Mode:", format::emph::BOLD + format::align::LEFT, col_size) << mode
+        << '\n';
+
     out << format::apply("Verdict:", format::emph::BOLD + format::align::LEFT, col_size)
         << format::apply(ver_string[ans], ver_style.at(ans) + format::align::LEFT) << '\n';
 
@@ -197,33 +462,78 @@ int judge(const std::string &solution_path, std::ostream &out, std::ostream &err
     out << format::apply("Max memory:", format::emph::BOLD + format::align::LEFT, col_size)
         << format::apply(as_string(mmax, 3), format::style::FLOAT) << '\n';
 
+    if (unique)
+        out << format::apply("Unique:", format::emph::BOLD + format::align::LEFT, col_size)
+            << format::apply(std::to_string(judged), format::style::INT) << " of "
+            << format::apply(std::to_string(files.size()), format::style::INT)
+            << " tests judged\n";
+
+    if (overhead > 0)
+        out << format::apply("Startup:", format::emph::BOLD + format::align::LEFT, col_size)
+            << format::apply(as_string(overhead, 6), format::style::FLOAT)
+            << (subtract_startup ? " (subtracted from each test)\n"
+                                 : " (included in the running times)\n");
+
     return ans;
 }
 
 // API functions
 int run(int argc, char *const argv[], std::ostream &out, std::ostream &err) {
     int option = -1;
-    std::string target{"."};
+    std::string profile;
+    bool sanitize = false, fork_server = false, fail_fast = false, unique = false;
+    bool subtract_startup = false;
 
-    while ((option = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+    while ((option = getopt_long(argc, argv, "hfp:stux", longopts, NULL)) != -1) {
         switch (option) {
         case 'h':
             out << help() << '\n';
             return 0;
 
+        case 'p':
+            profile = std::string(optarg);
+            break;
+
+        case 'f':
+            fork_server = true;
+            break;
+
+        case 's':
+            sanitize = true;
+            break;
+
+        case 'x':
+            fail_fast = true;
+            break;
+
+        case 'u':
+            unique = true;
+            break;
+
+        case 't':
+            subtract_startup = true;
+            break;
+
         default:
             err << help() << '\n';
             return CP_TOOLS_ERROR_CLEAN_INVALID_OPTION;
         }
     }
 
-    if (argc < 3) {
+    // getopt_long() moves the non-options arguments ('judge' and the solution) to the end
+    if (optind + 1 >= argc) {
         err << usage() << '\n';
         return CP_TOOLS_ERROR_MISSING_ARGUMENT;
     }
 
-    auto solution_path = argv[2];
+    if (sanitize and fork_server) {
+        err << message::failure("Options -f and -s can't be used together") << '\n';
+        return CP_TOOLS_ERROR_INVALID_OPTION;
+    }
+
+    auto solution_path = argv[optind + 1];
 
-    return judge(solution_path, out, err);
+    return judge(solution_path, profile, sanitize, fork_server, fail_fast, unique, subtract_startup,
+                 out, err);
 }
 } // namespace cptools::commands::judge
@@ -0,0 +1,168 @@
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+#include <zlib.h>
+
+// Defined by the Makefile, which links with libzstd when it finds its header
+#ifdef CP_TOOLS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "compress.h"
+#include "error.h"
+#include "util.h"
+
+namespace cptools::compress {
+
+static const size_t BLOCK_SIZE = 1 << 16;
+
+static bool has_extension(const std::string &path, const std::string &ext) {
+    return path.size() > ext.size() and path.substr(path.size() - ext.size()) == ext;
+}
+
+bool is_compressed(const std::string &path) {
+    return has_extension(path, ".gz") or has_extension(path, ".zst");
+}
+
+static const fs::Result gunzip(const std::string &src, const std::string &dst) {
+    auto in = gzopen(src.c_str(), "rb");
+
+    if (in == NULL)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ, "Can't open " + src);
+
+    // zlib reads files without a gzip header as they are, which would hide a corrupted test
+    if (gzdirect(in)) {
+        gzclose(in);
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ, src + " is not a gzip file");
+    }
+
+    std::unique_ptr<FILE, decltype(&fclose)> out(fopen(dst.c_str(), "wb"), &fclose);
+    std::vector<char> buffer(BLOCK_SIZE);
+    int n;
+
+    while (out and (n = gzread(in, buffer.data(), buffer.size())) > 0)
+        if (fwrite(buffer.data(), 1, n, out.get()) != (size_t)n)
+            break;
+
+    bool ok = out and gzeof(in) and not ferror(out.get());
+    gzclose(in);
+
+    if (not ok)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ, "Can't decompress " + src);
+
+    return fs::make_result(true);
+}
+
+#ifdef CP_TOOLS_HAVE_ZSTD
+static const fs::Result unzstd(const std::string &src, const std::string &dst) {
+    std::unique_ptr<FILE, decltype(&fclose)> in(fopen(src.c_str(), "rb"), &fclose);
+    std::unique_ptr<FILE, decltype(&fclose)> out(fopen(dst.c_str(), "wb"), &fclose);
+    std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> stream(ZSTD_createDStream(),
+                                                                      &ZSTD_freeDStream);
+
+    if (not in or not out or not stream)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ, "Can't open " + src);
+
+    std::vector<char> input(ZSTD_DStreamInSize()), output(ZSTD_DStreamOutSize());
+    size_t n, last = 0;
+
+    ZSTD_initDStream(stream.get());
+
+    while ((n = fread(input.data(), 1, input.size(), in.get())) > 0) {
+        ZSTD_inBuffer ib{input.data(), n, 0};
+
+        while (ib.pos < ib.size) {
+            ZSTD_outBuffer ob{output.data(), output.size(), 0};
+            last = ZSTD_decompressStream(stream.get(), &ob, &ib);
+
+            if (ZSTD_isError(last) or fwrite(output.data(), 1, ob.pos, out.get()) != ob.pos)
+                return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ,
+                                       "Can't decompress " + src);
+        }
+    }
+
+    // A non-zero hint means the last frame was truncated
+    if (last != 0 or ferror(in.get()))
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_READ, "Can't decompress " + src);
+
+    return fs::make_result(true);
+}
+#endif
+
+const fs::Result decompress(const std::string &src, const std::string &dst) {
+    if (has_extension(src, ".gz"))
+        return gunzip(src, dst);
+
+#ifdef CP_TOOLS_HAVE_ZSTD
+    if (has_extension(src, ".zst"))
+        return unzstd(src, dst);
+#endif
+
+    return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_UNSUPPORTED,
+                           "Unsupported compression format: " + src);
+}
+
+const fs::Result compress(const std::string &src, const std::string &dst) {
+    std::unique_ptr<FILE, decltype(&fclose)> in(fopen(src.c_str(), "rb"), &fclose);
+
+    if (not in)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_WRITE, "Can't open " + src);
+
+    // Answers are written once and read a few times, so speed matters more than size
+    auto out = gzopen(dst.c_str(), "wb1");
+
+    if (out == NULL)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_WRITE, "Can't create " + dst);
+
+    std::vector<char> buffer(BLOCK_SIZE);
+    size_t n;
+    bool ok = true;
+
+    while (ok and (n = fread(buffer.data(), 1, buffer.size(), in.get())) > 0)
+        ok = gzwrite(out, buffer.data(), n) == (int)n;
+
+    ok = (gzclose(out) == Z_OK) and ok and not ferror(in.get());
+
+    if (not ok)
+        return fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_WRITE, "Can't compress " + src);
+
+    return fs::make_result(true);
+}
+
+const fs::Result plain_file(const std::string &path, const std::string &cache_dir,
+                            std::string &plain) {
+    static std::atomic<int> calls{0};
+
+    if (not is_compressed(path)) {
+        plain = path;
+        return fs::make_result(true);
+    }
+
+    plain = cache_dir + "/" + util::sha_512_file(path).substr(0, 64);
+
+    if (fs::is_file(plain).ok)
+        return fs::make_result(true);
+
+    auto res = fs::create_directory(cache_dir);
+
+    if (not res.ok)
+        return res;
+
+    // Decompressed aside, so a concurrent reader never sees a partial file
+    auto tmp = plain + ".tmp-" + std::to_string(getpid()) + "-" + std::to_string(calls++);
+
+    res = decompress(path, tmp);
+
+    if (res.ok and rename(tmp.c_str(), plain.c_str()) == -1)
+        res = fs::make_result(false, CP_TOOLS_ERROR_COMPRESS_WRITE, "Can't write " + plain);
+
+    if (not res.ok)
+        fs::remove(tmp);
+
+    return res;
+}
+
+} // namespace cptools::compress
@@ -31,4 +31,46 @@ std::vector<std::string> get_solutions_file_names(const nlohmann::json &json_obj
     return file_names;
 }
 
-} // namespace cptools::config
\ No newline at end of file
+sh::Profile get_compiler_profile(const nlohmann::json &json_object, const std::string &name) {
+    auto profile_name = name;
+
+    if (profile_name.empty())
+        profile_name =
+            util::get_json_value<std::string>(json_object, "compilers|profile", "default");
+
+    auto path = "compilers|profiles|" + profile_name;
+    auto languages = util::get_json_value(json_object, path, nlohmann::json::object());
+
+    // Missing fields keep their default values
+    auto profile = sh::default_profile();
+
+    for (const auto &item : languages.items()) {
+        auto &compiler = profile[item.key()];
+        auto prefix = path + "|" + item.key() + "|";
+
+        compiler.compiler =
+            util::get_json_value(json_object, prefix + "compiler", compiler.compiler);
+        compiler.standard =
+            util::get_json_value(json_object, prefix + "standard", compiler.standard);
+        compiler.optimisation =
+            util::get_json_value(json_object, prefix + "optimisation", compiler.optimisation);
+        compiler.defines = util::get_json_value(json_object, prefix + "defines", compiler.defines);
+        compiler.flags = util::get_json_value(json_object, prefix + "flags", compiler.flags);
+        compiler.link = util::get_json_value(json_object, prefix + "link", compiler.link);
+        compiler.runtime = util::get_json_value(json_object, prefix + "runtime", compiler.runtime);
+    }
+
+    return profile;
+}
+
+std::string get_solution_profile_name(const nlohmann::json &json_object,
+                                      const std::string &solution) {
+    auto solutions = util::get_json_value(json_object, "compilers|solutions", nlohmann::json());
+
+    if (not solutions.is_object() or solutions.count(solution) == 0)
+        return "";
+
+    return solutions[solution].is_string() ? solutions[solution].get<std::string>() : "";
+}
+
+} // namespace cptools::config
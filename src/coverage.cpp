@@ -0,0 +1,61 @@
+#include <sstream>
+
+#include "coverage.h"
+#include "util.h"
+
+namespace cptools::coverage {
+
+// Lines are either '"name": [min-value-hit] [max-value-hit]' or 'feature "name": [hit]'
+void merge(Report &report, int test, const std::string &log) {
+    std::istringstream iss(log);
+    std::string line;
+
+    while (getline(iss, line)) {
+        auto feature = line.rfind("feature \"", 0) == 0;
+        auto first = line.find('"');
+        auto last = line.rfind("\":");
+
+        if (first == std::string::npos or last == std::string::npos or last <= first)
+            continue;
+
+        auto name = line.substr(first + 1, last - first - 1);
+        auto hits = util::split(util::strip(line.substr(last + 2)));
+
+        if (feature) {
+            auto &tests = report.features[name];
+
+            for (auto hit : hits)
+                if (hit == "hit")
+                    tests.push_back(test);
+
+            continue;
+        }
+
+        auto &variable = report.variables[name];
+
+        for (auto hit : hits) {
+            if (hit == "min-value-hit")
+                variable.min_hits.push_back(test);
+            else if (hit == "max-value-hit")
+                variable.max_hits.push_back(test);
+        }
+    }
+}
+
+std::string ranges(const std::vector<int> &tests) {
+    std::string result;
+
+    for (size_t i = 0, j; i < tests.size(); i = j) {
+        for (j = i + 1; j < tests.size() and tests[j] == tests[j - 1] + 1; ++j)
+            ;
+
+        result += (result.empty() ? "" : ", ") + std::to_string(tests[i]);
+
+        if (j - i > 1)
+            result += "-" + std::to_string(tests[j - 1]);
+    }
+
+    return result;
+}
+
+} // namespace cptools::coverage
@@ -0,0 +1,268 @@
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "forkserver.h"
+#include "fs.h"
+
+// Raw strings
+static const std::string stub_source{
+    R"source(#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHANNEL 198
+
+struct request {
+    long long timeout;
+    char infile[4096];
+    char outfile[4096];
+};
+
+struct reply {
+    long long status;
+    long long elapsed;
+    long long memory;
+};
+
+extern char **environ;
+
+int __real_main(int argc, char **argv, char **envp);
+
+static int transfer(void *data, size_t size, int writing) {
+    char *p = data;
+
+    while (size > 0) {
+        ssize_t n = writing ? write(CHANNEL, p, size) : read(CHANNEL, p, size);
+
+        if (n <= 0)
+            return 0;
+
+        p += n;
+        size -= n;
+    }
+
+    return 1;
+}
+
+int __wrap_main(int argc, char **argv, char **envp) {
+    if (!getenv("CP_TOOLS_FORKSERVER"))
+        return __real_main(argc, argv, envp);
+
+    unsetenv("CP_TOOLS_FORKSERVER");
+
+    struct reply hello = {0, 0, 0};
+    struct request req;
+
+    if (!transfer(&hello, sizeof hello, 1))
+        _exit(1);
+
+    while (transfer(&req, sizeof req, 0)) {
+        struct timespec start, end;
+        struct rusage usage = {0};
+        int status = 127 << 8;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            int in = open(req.infile, O_RDONLY);
+            int out = open(req.outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            if (in < 0 || out < 0)
+                _exit(127);
+
+            dup2(in, 0);
+            dup2(out, 1);
+            close(in);
+            close(out);
+            close(CHANNEL);
+
+            if (req.timeout > 0)
+                alarm(req.timeout);
+
+            return __real_main(argc, argv, environ);
+        }
+
+        if (pid > 0 && wait4(pid, &status, 0, &usage) < 0)
+            status = 127 << 8;
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        struct reply rep = {status,
+                            (end.tv_sec - start.tv_sec) * 1000000000LL +
+                                (end.tv_nsec - start.tv_nsec),
+                            usage.ru_maxrss};
+
+        if (!transfer(&rep, sizeof rep, 1))
+            break;
+    }
+
+    _exit(0);
+}
+)source"};
+
+namespace cptools::forkserver {
+
+// The stub reads the requests and writes the replies on this descriptor
+static const int CHANNEL = 198;
+
+// Time given to the program to reach main()
+static const int STARTUP_TIMEOUT_MS = 5000;
+
+// Must match the structs of the stub
+struct Request {
+    long long timeout;
+    char infile[4096];
+    char outfile[4096];
+};
+
+struct Reply {
+    long long status;
+    long long elapsed; // In nanoseconds
+    long long memory;  // In KB
+};
+
+static bool transfer(int fd, void *data, size_t size, bool writing) {
+    auto p = static_cast<char *>(data);
+
+    while (size > 0) {
+        auto n = writing ? send(fd, p, size, MSG_NOSIGNAL) : recv(fd, p, size, 0);
+
+        if (n <= 0)
+            return false;
+
+        p += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+std::vector<std::string> link_options(const std::string &dir) {
+    auto source = dir + "/forkserver.c";
+    auto object = std::filesystem::absolute(dir + "/forkserver.o").string();
+
+    if (fs::read_file(source) != stub_source or not fs::is_file(object).ok) {
+        fs::overwrite_file(source, stub_source);
+
+        auto res = sh::execute("gcc", "-O2 -c -o " + object + " " + source, "", "/dev/null", 30);
+
+        if (res.rc != 0) {
+            fs::remove(object);
+            return {};
+        }
+    }
+
+    return {object, "-Wl,--wrap=main"};
+}
+
+bool start(Server &server, const std::string &program) {
+    // Other threads (as the generation of the tests) may be running, so the child only calls
+    // async-signal-safe functions: its arguments and environment are built before the fork
+    std::vector<std::string> variables{"CP_TOOLS_FORKSERVER=1"};
+
+    for (auto var = environ; *var; ++var)
+        if (strncmp(*var, "CP_TOOLS_FORKSERVER=", 20) != 0)
+            variables.push_back(*var);
+
+    std::vector<char *> envp;
+
+    for (auto &var : variables)
+        envp.push_back(var.data());
+
+    envp.push_back(nullptr);
+
+    char *const argv[]{(char *)program.c_str(), nullptr};
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1)
+        return false;
+
+    auto pid = fork();
+
+    if (pid == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        auto null = open("/dev/null", O_RDWR);
+
+        // dup2() does nothing if the socket already is the channel, which must stay open on exec
+        if (fds[1] == CHANNEL)
+            fcntl(CHANNEL, F_SETFD, 0);
+        else
+            dup2(fds[1], CHANNEL);
+
+        dup2(null, 0);
+        dup2(null, 1);
+        dup2(null, 2);
+
+        execve(program.c_str(), argv, envp.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    server = {pid, fds[0]};
+
+    // The stub says hello when the program reaches main()
+    struct pollfd pfd { server.channel, POLLIN, 0 };
+    Reply hello;
+
+    if (poll(&pfd, 1, STARTUP_TIMEOUT_MS) <= 0 or
+        not transfer(server.channel, &hello, sizeof hello, false)) {
+        kill(server.pid, SIGKILL);
+        stop(server);
+        return false;
+    }
+
+    return true;
+}
+
+sh::Info run(Server &server, const std::string &infile, const std::string &outfile,
+             int timeout) {
+    Request request{timeout, {}, {}};
+    Reply reply;
+
+    if (infile.size() >= sizeof request.infile or outfile.size() >= sizeof request.outfile)
+        return {CP_TOOLS_ERROR_SH_EXEC_ERROR, 0, 0};
+
+    strcpy(request.infile, infile.c_str());
+    strcpy(request.outfile, outfile.c_str());
+
+    if (not transfer(server.channel, &request, sizeof request, true) or
+        not transfer(server.channel, &reply, sizeof reply, false))
+        return {CP_TOOLS_ERROR_SH_EXEC_ERROR, 0, 0};
+
+    int status = reply.status;
+    int rc = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    return {rc, reply.elapsed / 1e9, reply.memory / 1024.0};
+}
+
+void stop(Server &server) {
+    if (server.channel != -1)
+        close(server.channel);
+
+    if (server.pid > 0)
+        waitpid(server.pid, NULL, 0);
+
+    server = {-1, -1};
+}
+
+} // namespace cptools::forkserver
@@ -1,9 +1,16 @@
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
 #include <filesystem>
 #include <fstream>
+#include <linux/fs.h>
 #include <pwd.h>
+#include <sstream>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <vector>
 
 #include "dirs.h"
 #include "error.h"
@@ -35,8 +42,9 @@ const Result create_directory(const std::string &path) {
         return make_result(false, CP_TOOLS_ERROR_CPP_FILESYSTEM_CREATE_DIRECTORY, err);
     }
 
-    if (created)
-        return make_result(created);
+    // Another thread or process may have created it in the meantime
+    if (created or is_directory(path).ok)
+        return make_result(true);
     else
         return make_result(created, CP_TOOLS_ERROR_CPP_FILESYSTEM_CREATE_DIRECTORY,
                            "Failed to create directory " + path);
@@ -67,6 +75,136 @@ const Result copy(const std::string &src, const std::string &dst, bool overwrite
     return make_result(true);
 }
 
+// True if both files have the same contents
+static bool same_contents(const std::string &a, const std::string &b) {
+    std::error_code ec;
+
+    if (std::filesystem::equivalent(a, b, ec))
+        return true;
+
+    if (ec or std::filesystem::file_size(a, ec) != std::filesystem::file_size(b, ec) or ec)
+        return false;
+
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    std::vector<char> ba(64 * 1024), bb(64 * 1024);
+
+    while (fa and fb) {
+        fa.read(ba.data(), ba.size());
+        fb.read(bb.data(), bb.size());
+
+        if (fa.gcount() != fb.gcount() or memcmp(ba.data(), bb.data(), fa.gcount()))
+            return false;
+    }
+
+    return fa.eof() and fb.eof();
+}
+
+// Copies the contents with a reflink, if the filesystem shares extents (Btrfs, XFS), or in the
+// kernel, with copy_file_range()
+static bool clone_or_copy(int in, int out, off_t size) {
+#ifdef FICLONE
+    if (ioctl(out, FICLONE, in) == 0)
+        return true;
+#endif
+
+    for (off_t copied = 0; copied < size;) {
+        auto n = copy_file_range(in, NULL, out, NULL, size - copied, 0);
+
+        if (n <= 0)
+            break;
+
+        copied += n;
+    }
+
+    if (lseek(out, 0, SEEK_END) == size)
+        return true;
+
+    // Older kernels don't copy across filesystems
+    char buffer[64 * 1024];
+    ssize_t n;
+
+    if (lseek(in, 0, SEEK_SET) == -1 or ftruncate(out, 0) == -1 or lseek(out, 0, SEEK_SET) == -1)
+        return false;
+
+    while ((n = read(in, buffer, sizeof buffer)) > 0)
+        if (write(out, buffer, n) != n)
+            return false;
+
+    return n == 0;
+}
+
+static const Result materialize_file(const std::string &src, const std::string &dst,
+                                     bool allow_link) {
+    if (is_file(dst).ok and same_contents(src, dst))
+        return make_result(true);
+
+    static std::atomic<int> calls{0};
+
+    // The file is written aside and then renamed, so dst is never left half written
+    auto tmp = dst + ".tmp-" + std::to_string(getpid()) + "-" + std::to_string(calls++);
+    auto error = [&](const std::string &what) {
+        auto message = what + " '" + dst + "': " + strerror(errno);
+        unlink(tmp.c_str());
+
+        return make_result(false, CP_TOOLS_ERROR_CPP_FILESYSTEM_COPY, message);
+    };
+
+    if (not allow_link or link(src.c_str(), tmp.c_str()) == -1) {
+        struct stat sb;
+        auto in = open(src.c_str(), O_RDONLY);
+
+        if (in == -1 or fstat(in, &sb) == -1) {
+            if (in != -1)
+                close(in);
+
+            return error("Can't read the source of");
+        }
+
+        auto out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, sb.st_mode & 0777);
+        auto ok = out != -1 and clone_or_copy(in, out, sb.st_size);
+
+        close(in);
+
+        if (out != -1)
+            close(out);
+
+        if (not ok)
+            return error("Can't write");
+    }
+
+    if (rename(tmp.c_str(), dst.c_str()) == -1)
+        return error("Can't replace");
+
+    return make_result(true);
+}
+
+const Result materialize(const std::string &src, const std::string &dst, bool allow_link) {
+    if (not is_directory(src).ok)
+        return materialize_file(src, dst, allow_link);
+
+    try {
+        std::filesystem::create_directories(dst);
+
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(src)) {
+            auto target = std::filesystem::path(dst) / entry.path().lexically_relative(src);
+
+            if (entry.is_directory()) {
+                std::filesystem::create_directories(target);
+                continue;
+            }
+
+            auto res = materialize_file(entry.path().string(), target.string(), allow_link);
+
+            if (not res.ok)
+                return res;
+        }
+    } catch (const std::filesystem::filesystem_error &err) {
+        return make_result(false, CP_TOOLS_ERROR_CPP_FILESYSTEM_COPY, err);
+    }
+
+    return make_result(true);
+}
+
 const Result remove(const std::string &path) {
     if (not fs::exists(path).ok)
         return make_result(true);
@@ -129,6 +267,15 @@ void overwrite_file(const std::string dst, const std::string content) {
     file.close();
 }
 
+std::string read_file(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream oss;
+
+    oss << file.rdbuf();
+
+    return oss.str();
+}
+
 std::string get_home_dir() {
     char *homedir = getenv("HOME");
     if (homedir == NULL) {
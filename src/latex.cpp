@@ -0,0 +1,89 @@
+#include <filesystem>
+#include <set>
+
+#include "dirs.h"
+#include "error.h"
+#include "fs.h"
+#include "latex.h"
+#include "util.h"
+
+namespace cptools::latex {
+
+// Arguments of the commands of a LaTeX document that name existing files
+static std::set<std::string> referenced_files(const std::string &tex) {
+    std::set<std::string> files;
+
+    for (size_t i = tex.find('{'); i != std::string::npos; i = tex.find('{', i + 1)) {
+        auto j = tex.find('}', i);
+
+        if (j == std::string::npos)
+            break;
+
+        auto arg = tex.substr(i + 1, j - i - 1);
+
+        if (arg.empty() or arg.find_first_of("{\\\n") != std::string::npos)
+            continue;
+
+        for (auto path : {arg, arg + ".tex"})
+            if (fs::is_file(path).ok)
+                files.insert(path);
+    }
+
+    return files;
+}
+
+std::string sources_hash(const std::string &texfile, const std::string &doc_class) {
+    auto tex = fs::read_file(texfile);
+    auto files = referenced_files(tex);
+
+    std::error_code ec;
+
+    if (std::filesystem::is_directory("tex", ec))
+        for (const auto &entry : std::filesystem::recursive_directory_iterator("tex", ec))
+            if (entry.is_regular_file())
+                files.insert(entry.path().string());
+
+    // The class is looked up as pdflatex does, on the working directory first
+    for (auto dir : {std::string("./"), std::string(CP_TOOLS_CLASSES_DIR)}) {
+        auto cls = dir + doc_class + ".cls";
+
+        if (fs::is_file(cls).ok) {
+            files.insert(cls);
+            break;
+        }
+    }
+
+    // The names are hashed along with the contents, so renames are noticed too
+    std::string hashes{util::sha_512(tex)};
+
+    for (const auto &file : files)
+        hashes += "\n" + file + "\n" + util::sha_512_file(file);
+
+    return util::sha_512(hashes);
+}
+
+sh::Result build(const std::string &pdf, const std::string &texfile, const std::string &doc_class,
+                 bool &rebuilt) {
+    auto stamp = pdf + ".sources";
+    auto hash = sources_hash(texfile, doc_class);
+
+    rebuilt = false;
+
+    if (fs::is_file(pdf).ok and fs::read_file(stamp) == hash)
+        return {CP_TOOLS_OK, ""};
+
+    // The stamp goes away first, so a failed build is never taken as up to date
+    fs::remove(stamp);
+    fs::remove(pdf);
+
+    auto res = sh::build(pdf, texfile);
+
+    if (res.rc == CP_TOOLS_OK) {
+        fs::overwrite_file(stamp, hash);
+        rebuilt = true;
+    }
+
+    return res;
+}
+
+} // namespace cptools::latex
@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+namespace cptools::parallel {
+
+size_t max_workers() {
+    auto cores = std::thread::hardware_concurrency();
+
+    return cores ? cores : 1;
+}
+
+void for_each(size_t n, const std::function<void(size_t)> &f, size_t workers) {
+    if (workers == 0)
+        workers = max_workers();
+
+    workers = std::min(workers, n);
+
+    if (workers <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            f(i);
+
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+
+    for (size_t w = 0; w < workers; ++w)
+        threads.emplace_back([&]() {
+            for (size_t i = next++; i < n; i = next++)
+                f(i);
+        });
+
+    for (auto &t : threads)
+        t.join();
+}
+
+} // namespace cptools::parallel
@@ -0,0 +1,245 @@
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "script.h"
+#include "util.h"
+
+namespace cptools::script {
+
+using Variables = std::map<std::string, long long>;
+
+struct Context {
+    std::vector<std::string> lines;
+    std::vector<Command> commands;
+    size_t tests;
+    size_t iterations; // Of all loops, nested ones included
+    std::string error;
+};
+
+static bool fail(Context &context, size_t line, const std::string &message) {
+    context.error = "Line " + std::to_string(line + 1) + ": " + message;
+    return false;
+}
+
+static bool is_blank(const std::string &line) { return line.empty() or line.front() == '#'; }
+
+static std::string keyword(const std::string &line) { return util::split(line).front(); }
+
+// Replaces each ${name} by the value of the variable
+static bool substitute(Context &context, size_t line, const Variables &variables,
+                       std::string &text) {
+    std::string result;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '$' or i + 1 == text.size() or text[i + 1] != '{') {
+            result.push_back(text[i]);
+            continue;
+        }
+
+        auto end = text.find('}', i);
+
+        if (end == std::string::npos)
+            return fail(context, line, "missing '}'");
+
+        auto name = text.substr(i + 2, end - i - 2);
+        auto it = variables.find(name);
+
+        if (it == variables.end())
+            return fail(context, line, "unknown variable '" + name + "'");
+
+        result += std::to_string(it->second);
+        i = end;
+    }
+
+    text = result;
+    return true;
+}
+
+static bool to_integer(const std::string &s, long long &value) {
+    std::istringstream iss(s);
+    char extra;
+
+    return (iss >> value) and not(iss >> extra);
+}
+
+// Indexes of a multi-test target, as in "{1-5,7}"
+static bool parse_tests(Context &context, size_t line, const std::string &target,
+                        std::vector<int> &tests) {
+    if (target.size() < 3 or target.back() != '}')
+        return fail(context, line, "invalid target '" + target + "'");
+
+    std::set<long long> seen;
+
+    for (auto range : util::split(target.substr(1, target.size() - 2), ',')) {
+        auto bounds = util::split(util::strip(range), '-');
+        long long first, last;
+
+        if (bounds.empty() or bounds.size() > 2 or not to_integer(bounds.front(), first) or
+            not to_integer(bounds.back(), last) or first < 1 or last < first)
+            return fail(context, line, "invalid range '" + range + "'");
+
+        if (context.tests + (last - first + 1) > MAX_TESTS)
+            return fail(context, line, "too many tests");
+
+        // Each index is a file written by startTest(), so it can't be repeated
+        for (auto i = first; i <= last; ++i) {
+            if (not seen.insert(i).second)
+                return fail(context, line, "repeated test " + std::to_string(i));
+
+            tests.push_back(i);
+        }
+
+        context.tests += last - first + 1;
+    }
+
+    return true;
+}
+
+static bool parse_command(Context &context, size_t line, const Variables &variables) {
+    auto text = context.lines[line];
+
+    if (not substitute(context, line, variables, text))
+        return false;
+
+    auto pos = text.rfind('>');
+
+    if (pos == std::string::npos)
+        return fail(context, line, "missing '>' on generator call");
+
+    auto call = util::strip(text.substr(0, pos));
+    auto target = util::strip(text.substr(pos + 1));
+    auto space = call.find(' ');
+
+    Command command{call.substr(0, space),
+                    space == std::string::npos ? "" : util::strip(call.substr(space + 1)),
+                    {}};
+
+    if (command.generator.empty())
+        return fail(context, line, "missing generator name");
+
+    if (target == "$") {
+        if (++context.tests > MAX_TESTS)
+            return fail(context, line, "too many tests");
+    } else if (target.empty() or target.front() != '{')
+        return fail(context, line, "invalid target '" + target + "'");
+    else if (not parse_tests(context, line, target, command.tests))
+        return false;
+
+    context.commands.push_back(command);
+    return true;
+}
+
+// Line of the 'end' that closes the block started after the given line
+static bool block_end(Context &context, size_t start, size_t &end) {
+    int depth = 1;
+
+    for (end = start + 1; end < context.lines.size(); ++end) {
+        if (is_blank(context.lines[end]))
+            continue;
+
+        auto word = keyword(context.lines[end]);
+
+        depth += (word == "for") - (word == "end");
+
+        if (depth == 0)
+            return true;
+    }
+
+    return fail(context, start, "missing 'end'");
+}
+
+static bool expand_lines(Context &context, size_t begin, size_t end, Variables &variables);
+
+// for <name> in <first>..<last> [step <step>]
+static bool expand_loop(Context &context, size_t line, size_t end, Variables &variables) {
+    auto text = context.lines[line];
+
+    if (not substitute(context, line, variables, text))
+        return false;
+
+    auto tokens = util::split(text);
+    auto range = tokens.size() > 3 ? tokens[3] : "";
+    auto dots = range.find("..");
+
+    long long first, last, step = 1;
+
+    if ((tokens.size() != 4 and tokens.size() != 6) or tokens[2] != "in" or
+        dots == std::string::npos or not to_integer(range.substr(0, dots), first) or
+        not to_integer(range.substr(dots + 2), last) or
+        (tokens.size() == 6 and (tokens[4] != "step" or not to_integer(tokens[5], step))))
+        return fail(context, line, "expected 'for <name> in <first>..<last> [step <step>]'");
+
+    if (step <= 0)
+        return fail(context, line, "the step must be positive");
+
+    // The distance between the bounds is unsigned, since it may not fit on a long long
+    auto span = last < first ? 0 : (unsigned long long)last - (unsigned long long)first;
+
+    // The bound is on the iterations of the whole script, since nested loops multiply them
+    if (last >= first and span / step >= MAX_ITERATIONS - context.iterations)
+        return fail(context, line, "too many iterations");
+
+    size_t count = last < first ? 0 : span / step + 1;
+
+    context.iterations += count;
+
+    // The loop variable hides an outer one with the same name
+    auto name = tokens[1];
+    auto outer = variables;
+
+    // The values are counted from the first one, so they never step past the last one
+    for (size_t k = 0; k < count; ++k) {
+        variables[name] = (long long)((unsigned long long)first + k * step);
+
+        if (not expand_lines(context, line + 1, end, variables))
+            return false;
+    }
+
+    variables = outer;
+
+    return true;
+}
+
+static bool expand_lines(Context &context, size_t begin, size_t end, Variables &variables) {
+    for (auto line = begin; line < end; ++line) {
+        if (is_blank(context.lines[line]))
+            continue;
+
+        auto word = keyword(context.lines[line]);
+
+        if (word == "end")
+            return fail(context, line, "'end' without 'for'");
+
+        if (word == "for") {
+            size_t block;
+
+            if (not block_end(context, line, block) or
+                not expand_loop(context, line, block, variables))
+                return false;
+
+            line = block;
+        } else if (not parse_command(context, line, variables))
+            return false;
+    }
+
+    return true;
+}
+
+Result expand(const std::string &script) {
+    Context context{{}, {}, 0, 0, ""};
+    std::istringstream iss(script);
+    std::string line;
+
+    while (getline(iss, line))
+        context.lines.push_back(util::strip(line));
+
+    Variables variables;
+
+    if (not expand_lines(context, 0, context.lines.size(), variables))
+        return {false, context.error, {}};
+
+    return {true, "", context.commands};
+}
+
+} // namespace cptools::script
@@ -1,18 +1,165 @@
 #include <algorithm>
-
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "compress.h"
 #include "config.h"
 #include "dirs.h"
 #include "error.h"
 #include "fs.h"
 #include "message.h"
+#include "parallel.h"
+#include "script.h"
 #include "sh.h"
 #include "task.h"
 #include "util.h"
 
 namespace cptools::task {
 
-std::vector<std::pair<std::string, std::string>>
-generate_io_files(const std::string &testset, std::ostream &, std::ostream &err, bool gen_output) {
+static const std::string manifest_path{std::string(CP_TOOLS_BUILD_DIR) + "/tests.json"};
+
+// Keys of the input and of the answer of each test, indexed by its number
+static nlohmann::json read_manifest() {
+    auto manifest = nlohmann::json::parse(fs::read_file(manifest_path), nullptr, false);
+
+    return manifest.is_object() ? manifest : nlohmann::json::object();
+}
+
+// Time limit (in seconds) of a generator call that writes many tests
+static const int MULTITEST_TIMEOUT = 60;
+
+// A test and where it comes from
+struct Origin {
+    std::string set;       // "samples", "manual" or "random"
+    std::string source;    // File, for samples and manual tests, or generator arguments
+    std::string generator; // Name of the generator of random tests
+    int call;              // Generator call that writes many tests (-1 if none)
+    int index;             // Index of the test on that call
+};
+
+// Generators available to the scripts, by name: the default one, by the name of its file, and
+// the ones listed on 'tools|generators'
+static std::map<std::string, std::string> generator_sources(const nlohmann::json &config) {
+    auto sources = util::get_json_value(config, "tools|generators",
+                                        std::map<std::string, std::string>{});
+    auto source = util::get_json_value(config, "tools|generator", std::string());
+
+    if (not source.empty())
+        sources[std::filesystem::path(source).stem().string()] = source;
+
+    return sources;
+}
+
+static std::string generator_program(const nlohmann::json &config, const std::string &name) {
+    auto source = util::get_json_value(config, "tools|generator", std::string());
+
+    if (not source.empty() and std::filesystem::path(source).stem().string() == name)
+        return std::string(CP_TOOLS_BUILD_DIR) + "/generator";
+
+    return std::string(CP_TOOLS_BUILD_DIR) + "/generators/" + name;
+}
+
+// The parameters of 'tests|random' are calls of the default generator, followed by the calls
+// of the script, given by 'tests|script' (a string or a list of lines) or 'tests|script_file'
+static bool random_tests(const nlohmann::json &config, std::vector<script::Command> &calls,
+                         std::string &error) {
+    auto parameters = util::get_json_value(config, "tests|random", std::vector<std::string>{});
+
+    if (not parameters.empty()) {
+        auto source = util::get_json_value(config, "tools|generator", std::string());
+
+        if (source.empty()) {
+            error = "Generator file not found!";
+            return false;
+        }
+
+        for (auto args : parameters)
+            calls.push_back({std::filesystem::path(source).stem().string(), args, {}});
+    }
+
+    auto text = util::get_json_value(config, "tests|script", std::string());
+
+    for (auto line : util::get_json_value(config, "tests|script", std::vector<std::string>{}))
+        text += line + "\n";
+
+    auto file = util::get_json_value(config, "tests|script_file", std::string());
+
+    if (not file.empty()) {
+        if (not fs::is_file(file).ok) {
+            error = "Script file '" + file + "' not found!";
+            return false;
+        }
+
+        text += "\n" + fs::read_file(file);
+    }
+
+    auto res = script::expand(text);
+
+    if (not res.ok) {
+        error = "Invalid generation script: " + res.error_message;
+        return false;
+    }
+
+    calls.insert(calls.end(), res.commands.begin(), res.commands.end());
+
+    return true;
+}
+
+bool has_random_tests(const nlohmann::json &config) {
+    return not util::get_json_value(config, "tests|random", std::vector<std::string>{}).empty() or
+           not util::get_json_value(config, "tests|script", nlohmann::json()).is_null() or
+           not util::get_json_value(config, "tests|script_file", std::string()).empty();
+}
+
+// Keys of the manifests: an input copied from a file changes only with the file, and an answer
+// only with the input and with the build of the solution (its program and its source)
+static std::string file_input_key(const std::string &source) {
+    return util::sha_512("file\n" + util::sha_512_file(source));
+}
+
+static std::string solution_key(const build::Target &solution) {
+    return util::sha_512(util::sha_512_file(solution.output) + "\n" +
+                         util::sha_512_file(solution.source));
+}
+
+static std::string solution_answer_key(const std::string &solution_hash,
+                                       const std::string &input_key, bool compressed) {
+    return util::sha_512(solution_hash + "\n" + input_key + (compressed ? "\ngz" : ""));
+}
+
+// Holds an exclusive lock on a file while in scope: the tests of a problem are written by a
+// single process at a time (as the concurrent genpdf calls of 'contest pdf')
+class FileLock {
+  public:
+    explicit FileLock(const std::string &path) : fd(open(path.c_str(), O_CREAT | O_RDWR, 0644)) {
+        if (fd != -1)
+            flock(fd, LOCK_EX);
+    }
+
+    ~FileLock() {
+        if (fd != -1)
+            close(fd);
+    }
+
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+  private:
+    int fd;
+};
+
+int stream_io_files(const std::string &testset, std::ostream &out, std::ostream &err,
+                    const TestConsumer &consumer, bool gen_output, size_t workers) {
 
     std::vector<std::string> sets{"samples", "manual", "random"};
 
@@ -25,113 +172,501 @@ generate_io_files(const std::string &testset, std::ostream &, std::ostream &err,
 
     auto input_dir{std::string(CP_TOOLS_BUILD_DIR) + "/input/"};
     auto output_dir{std::string(CP_TOOLS_BUILD_DIR) + "/output/"};
-    auto program{std::string(CP_TOOLS_BUILD_DIR) + "/solution"};
+    auto decompressed_dir{std::string(CP_TOOLS_BUILD_DIR) + "/decompressed"};
 
     auto config = cptools::config::read_config_file();
-    auto source = cptools::util::get_json_value(config, "solutions|default", std::string("ERROR"));
-    source = "solutions/" + source;
+    auto compress_answers = util::get_json_value(config, "tests|compress_answers", false);
 
-    auto directories = {input_dir, output_dir};
+    auto directories = {std::string(CP_TOOLS_BUILD_DIR), input_dir, output_dir};
     for (auto &dir : directories) {
         auto fs_res = fs::create_directory(dir);
         if (not fs_res.ok) {
             err << message::failure(fs_res.error_message);
-            return {};
+            return CP_TOOLS_ERROR_TASK_GENERATION_FAILED;
         }
     }
 
-    if (source == "ERROR") {
+    FileLock lock(std::string(CP_TOOLS_BUILD_DIR) + "/tests.lock");
+
+    auto solution = solution_target();
+
+    if (solution.source.empty()) {
         err << message::failure("Default solution file not found!\n");
-        return {};
+        return CP_TOOLS_ERROR_TASK_GENERATION_FAILED;
     }
 
-    auto res = cptools::sh::build(program, source);
+    // Generator calls of the random tests, from 'tests|random' and from the script
+    std::vector<script::Command> calls;
 
-    if (res.rc != CP_TOOLS_OK) {
-        err << message::failure("Can't compile solution '" + source + "'!") << "\n";
-        err << message::trace(res.output) << '\n';
-        return {};
+    if (std::find(sets.begin(), sets.end(), "random") != sets.end()) {
+        std::string error;
+
+        if (not random_tests(config, calls, error)) {
+            err << message::failure(error) << "\n";
+            return CP_TOOLS_ERROR_TASK_GENERATION_FAILED;
+        }
     }
 
-    std::vector<std::pair<std::string, std::string>> io_files;
-    int next = 1;
+    // The solution and the generators are built concurrently
+    std::vector<build::Target> targets{solution};
+    std::map<std::string, std::string> generators; // Name and program of the used generators
 
-    for (auto s : sets) {
-        if (s == "random") {
-            source = cptools::util::get_json_value(config, "tools|generator", std::string("ERROR"));
+    auto sources = generator_sources(config);
 
-            if (source == "tools/ERROR") {
-                err << message::failure("Generator file not found!\n");
-                return {};
-            }
+    for (const auto &call : calls) {
+        if (generators.count(call.generator))
+            continue;
 
-            auto generator = std::string(CP_TOOLS_BUILD_DIR) + "/generator";
+        if (not sources.count(call.generator)) {
+            err << message::failure("Generator '" + call.generator + "' not found!") << "\n";
+            return CP_TOOLS_ERROR_TASK_GENERATION_FAILED;
+        }
 
-            res = cptools::sh::build(generator, source);
+        auto output = generator_program(config, call.generator);
 
-            if (res.rc != CP_TOOLS_OK) {
-                err << message::failure("Can't compile generator '" + source + "'!") << "\n";
-                err << message::trace(res.output) << '\n';
-                return {};
-            }
+        generators[call.generator] = output;
+        fs::create_directory(std::filesystem::path(output).parent_path().string());
+        targets.push_back(
+            {output, sources[call.generator], config::get_compiler_profile(config)});
+    }
 
-            auto inputs =
-                cptools::util::get_json_value(config, "tests|random", std::vector<std::string>{});
+    for (auto report : build::run(targets)) {
+        if (report.result.rc != CP_TOOLS_OK) {
+            err << message::failure("Can't compile '" + report.target.source + "'!") << "\n";
+            err << message::trace(report.result.output) << '\n';
+            return CP_TOOLS_ERROR_TASK_GENERATION_FAILED;
+        }
+    }
 
-            for (auto parameters : inputs) {
-                std::string dest{input_dir + std::to_string(next++)};
+    auto program = solution.output;
 
-                auto res = sh::execute(generator, parameters, "", dest);
+    // The tests are numbered in order, then generated (or copied) and answered concurrently
+    std::vector<std::pair<std::string, std::string>> io_files;
+    std::vector<Origin> origins;
+    int next = 1;
 
-                if (res.rc != CP_TOOLS_OK) {
-                    err << message::failure("Error generating '" + dest + "' with parameters " +
-                                            parameters)
-                        << "\n";
-                    err << message::trace(res.output) << '\n';
-                    return {};
+    for (auto s : sets) {
+        if (s == "random") {
+            for (size_t c = 0; c < calls.size(); ++c) {
+                auto &call = calls[c];
+
+                if (call.tests.empty()) {
+                    io_files.emplace_back(input_dir + std::to_string(next++), "");
+                    origins.push_back({s, call.args, call.generator, -1, 0});
                 }
 
-                io_files.emplace_back(std::make_pair(dest, ""));
+                for (auto index : call.tests) {
+                    io_files.emplace_back(input_dir + std::to_string(next++), "");
+                    origins.push_back({s, call.args, call.generator, (int)c, index});
+                }
             }
         } else {
             auto inputs = cptools::util::get_json_value(config, "tests|" + s,
                                                         std::map<std::string, std::string>{});
 
             for (auto [input, comment] : inputs) {
-                std::string dest{input_dir + std::to_string(next++)};
+                io_files.emplace_back(input_dir + std::to_string(next++), "");
+                origins.push_back({s, input, "", -1, 0});
+            }
+        }
+    }
 
-                auto res = fs::copy(input, dest, true);
-                if (not res.ok) {
-                    err << message::failure(res.error_message);
-                    return {};
-                }
+    // The manifest records the keys of the inputs and answers of each test: tests whose key
+    // didn't change are not generated again
+    auto manifest = read_manifest();
+    std::vector<std::pair<std::string, std::string>> keys(io_files.size()), old_keys;
+
+    // Hashes of the contents of the inputs, which tell the duplicated ones
+    std::vector<std::string> contents(io_files.size()), old_contents;
+
+    for (size_t i = 0; i < io_files.size(); ++i) {
+        auto number = std::to_string(i + 1);
+
+        old_keys.emplace_back(util::get_json_value(manifest, number + "|input", std::string()),
+                              util::get_json_value(manifest, number + "|answer", std::string()));
+        old_contents.push_back(
+            util::get_json_value(manifest, number + "|contents", std::string()));
+    }
+
+    std::map<std::string, std::string> generator_hashes;
+
+    for (auto [name, program] : generators)
+        generator_hashes[name] = util::sha_512_file(program);
+    auto solution_hash = solution_key(solution);
+
+    // Each test keeps its own error, so a failure doesn't stop the others
+    std::vector<std::string> errors(io_files.size());
 
-                io_files.emplace_back(std::make_pair(dest, ""));
+    // Calls that write many tests are run once, by the first of their tests to be made
+    std::vector<std::once_flag> call_flags(calls.size());
+    std::vector<std::string> call_errors(calls.size());
+
+    auto run_call = [&](size_t c) {
+        auto dir = std::string(CP_TOOLS_BUILD_DIR) + "/multitest/" + std::to_string(c);
+        auto program = std::filesystem::absolute(generators.at(calls[c].generator)).string();
+
+        fs::remove(dir);
+        fs::create_directory(std::string(CP_TOOLS_BUILD_DIR) + "/multitest");
+        fs::create_directory(dir);
+
+        // The tests are written by testlib's startTest() on the working directory
+        auto res = sh::execute("cd " + dir + " && timeout " + std::to_string(MULTITEST_TIMEOUT) +
+                                   "s " + program,
+                               calls[c].args, "", "/dev/null", 0);
+
+        if (res.rc != CP_TOOLS_OK)
+            call_errors[c] = message::trace(res.output) + "\n";
+    };
+
+    auto make = [&](size_t i) {
+        auto dest = io_files[i].first;
+        auto [set, source, generator, call, index] = origins[i];
+        auto number = std::to_string(i + 1);
+
+        auto &[input_key, answer_key] = keys[i];
+
+        if (set != "random")
+            input_key = file_input_key(source);
+        else if (call < 0)
+            input_key =
+                util::sha_512("random\n" + generator_hashes.at(generator) + "\n" + source);
+        else
+            input_key = util::sha_512("multitest\n" + generator_hashes.at(generator) + "\n" +
+                                      source + "\n" + std::to_string(index));
+
+        auto fresh = old_keys[i].first == input_key and fs::is_file(dest).ok;
+
+        if (not fresh and set == "random") {
+            auto error = message::failure("Error generating '" + dest + "' with " + generator +
+                                          " " + source) +
+                         "\n";
+
+            // The old file may be a hard link to a decompressed input, so it is not written over
+            fs::remove(dest);
+
+            if (call < 0) {
+                auto res = sh::execute(generators.at(generator), source, "", dest);
+
+                if (res.rc != CP_TOOLS_OK)
+                    errors[i] = error + message::trace(res.output) + "\n";
+            } else {
+                std::call_once(call_flags[call], run_call, call);
+
+                auto written = std::string(CP_TOOLS_BUILD_DIR) + "/multitest/" +
+                               std::to_string(call) + "/" + std::to_string(index);
+
+                if (not call_errors[call].empty())
+                    errors[i] = error + call_errors[call];
+                else if (not fs::materialize(written, dest, true).ok)
+                    errors[i] = error + message::trace("Test " + std::to_string(index) +
+                                                       " was not written by the generator") +
+                                "\n";
             }
+        } else if (not fresh) {
+            // Compressed sources are decompressed once, into a copy shared by later builds
+            std::string plain;
+            auto res = compress::plain_file(source, decompressed_dir, plain);
+
+            // The tests of the problem are cloned (or copied), so writing over a build input never
+            // edits them: only the decompressed copies, private to the build, are linked
+            if (res.ok)
+                res = fs::materialize(plain, dest, plain != source);
+
+            if (not res.ok)
+                errors[i] = message::failure(res.error_message) + "\n";
         }
-    }
 
-    if (gen_output) {
-        for (int i = 1; i < next; ++i) {
-            std::string input{io_files[i - 1].first};
-            std::string output{output_dir + std::to_string(i)};
+        if (not errors[i].empty()) {
+            input_key.clear();
+            return;
+        }
+
+        contents[i] = fresh and not old_contents[i].empty() ? old_contents[i]
+                                                            : util::sha_512_file(dest);
+
+        if (not gen_output) {
+            answer_key = fresh ? old_keys[i].second : "";
+            return;
+        }
+
+        // Samples are kept plain, since they are also read by the statement
+        auto compressed = compress_answers and set != "samples";
+
+        std::string output{output_dir + number};
+        std::string stored{compressed ? output + ".gz" : output};
+        answer_key = solution_answer_key(solution_hash, input_key, compressed);
+
+        if (old_keys[i].second == answer_key and fs::is_file(stored).ok) {
+            io_files[i].second = stored;
+            return;
+        }
+
+        fs::remove(output + ".gz");
+
+        auto res = cptools::sh::execute(program, "", dest, output);
+
+        if (res.rc != CP_TOOLS_OK) {
+            errors[i] = message::failure("Can't generate output for input '" + dest + "'!") +
+                        "\n" + message::trace(res.output) + "\n";
+            answer_key.clear();
+            return;
+        }
 
-            auto res = cptools::sh::execute(program, "", input, output);
+        if (compressed) {
+            auto fs_res = compress::compress(output, stored);
+            fs::remove(output);
 
-            if (res.rc != CP_TOOLS_OK) {
-                err << message::failure("Can't generate output for input '" + input + "'!") << "\n";
-                err << message::trace(res.output) << '\n';
-                return {};
+            if (not fs_res.ok) {
+                errors[i] = message::failure(fs_res.error_message) + "\n";
+                answer_key.clear();
+                return;
             }
+        }
+
+        io_files[i].second = stored;
+    };
+
+    // The tests are handed to the consumer in order, as soon as each one is ready, while the
+    // next ones are still being made
+    enum State { PENDING, READY, FAILED };
+
+    std::vector<State> states(io_files.size(), PENDING);
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::atomic<bool> cancelled{false};
+
+    auto produce = [&](size_t i) {
+        // Skipped tests keep their files, so their keys stay valid
+        if (cancelled) {
+            keys[i] = old_keys[i];
+            contents[i] = old_contents[i];
+        } else
+            make(i);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        states[i] = errors[i].empty() ? READY : FAILED;
+        ready.notify_all();
+    };
+
+    std::thread producer([&]() { parallel::for_each(io_files.size(), produce, workers); });
+
+    // First test with each input, and the tests that repeat it
+    std::map<std::string, size_t> first;
+    std::map<size_t, std::vector<size_t>> duplicates;
+
+    for (size_t i = 0; i < io_files.size(); ++i) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&]() { return states[i] != PENDING; });
+
+        auto state = states[i];
+        lock.unlock();
+
+        // After a failure the other tests are still made, so all failures are reported
+        if (state == FAILED)
+            break;
+
+        auto original = first.emplace(contents[i], i).first->second;
+
+        if (original != i)
+            duplicates[original].push_back(i);
+
+        if (not consumer(i, original, io_files[i].first, io_files[i].second)) {
+            cancelled = true;
+            break;
+        }
+    }
+
+    producer.join();
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        manifest[std::to_string(i + 1)] = {
+            {"input", keys[i].first}, {"answer", keys[i].second}, {"contents", contents[i]}};
+
+    fs::overwrite_file(manifest_path, manifest.dump(4));
+
+    for (auto [original, tests] : duplicates) {
+        std::string numbers;
+
+        for (auto i : tests)
+            numbers += (numbers.empty() ? "" : ", ") + std::to_string(i + 1);
+
+        out << message::warning("Test" + std::string(tests.size() > 1 ? "s " : " ") + numbers +
+                                " repeat" + (tests.size() > 1 ? "" : "s") + " the input of test " +
+                                std::to_string(original + 1))
+            << '\n';
+    }
+
+    bool failed = false;
+
+    for (const auto &error : errors) {
+        err << error;
+        failed |= not error.empty();
+    }
+
+    return failed ? CP_TOOLS_ERROR_TASK_GENERATION_FAILED : CP_TOOLS_OK;
+}
+
+std::vector<std::pair<std::string, std::string>>
+generate_io_files(const std::string &testset, std::ostream &out, std::ostream &err,
+                  bool gen_output) {
+    std::vector<std::pair<std::string, std::string>> io_files;
+
+    auto rc = stream_io_files(
+        testset, out, err,
+        [&](size_t, size_t, const std::string &input, const std::string &answer) {
+            io_files.emplace_back(input, answer);
+            return true;
+        },
+        gen_output);
+
+    return rc == CP_TOOLS_OK ? io_files : std::vector<std::pair<std::string, std::string>>{};
+}
+
+std::vector<std::pair<std::string, std::string>> sample_files(std::ostream &err) {
+    auto config = cptools::config::read_config_file();
+    auto sources =
+        util::get_json_value(config, "tests|samples", std::map<std::string, std::string>{});
+
+    std::string samples_dir{std::string(CP_TOOLS_BUILD_DIR) + "/samples"};
+
+    for (auto dir : {std::string(CP_TOOLS_BUILD_DIR), samples_dir, samples_dir + "/input",
+                     samples_dir + "/output"}) {
+        auto res = fs::create_directory(dir);
+
+        if (not res.ok) {
+            err << message::failure(res.error_message) << '\n';
+            return {};
+        }
+    }
+
+    auto solution = solution_target();
+
+    if (solution.source.empty()) {
+        err << message::failure("Default solution file not found!\n");
+        return {};
+    }
+
+    // Statements of many languages may be written at once (as by 'contest pdf')
+    FileLock lock(samples_dir + "/samples.lock");
+
+    auto manifest_file = samples_dir + "/samples.json";
+    auto old_manifest = nlohmann::json::parse(fs::read_file(manifest_file), nullptr, false);
+    auto samples_manifest = nlohmann::json::object();
+
+    if (not old_manifest.is_object())
+        old_manifest = nlohmann::json::object();
+
+    // The solution is built only if it is out of date (as when its source, its headers or its
+    // compiler options changed), and the answers are keyed by its build, as on the tests
+    auto reports = build::run({solution});
 
-            io_files[i - 1].second = output;
+    if (reports.front().result.rc != CP_TOOLS_OK) {
+        err << message::failure("Can't compile '" + solution.source + "'!") << "\n";
+        err << message::trace(reports.front().result.output) << '\n';
+        return {};
+    }
+
+    auto solution_hash = solution_key(solution);
+
+    std::vector<std::pair<std::string, std::string>> io_files;
+    std::vector<size_t> pending;
+    nlohmann::json tests;
+
+    for (auto [source, comment] : sources) {
+        auto number = std::to_string(io_files.size() + 1);
+        auto input = samples_dir + "/input/" + number;
+        auto output = samples_dir + "/output/" + number;
+
+        std::string plain;
+        auto res = compress::plain_file(source, samples_dir + "/decompressed", plain);
+
+        // As on the tests, only the decompressed copies are linked
+        if (res.ok)
+            res = fs::materialize(plain, input, plain != source);
+
+        if (not res.ok) {
+            err << message::failure(res.error_message) << '\n';
+            return {};
         }
+
+        auto input_key = file_input_key(source);
+        auto key = solution_answer_key(solution_hash, input_key, false);
+
+        io_files.emplace_back(input, output);
+        samples_manifest[number] = {{"input", input_key}, {"answer", key}};
+
+        if (util::get_json_value(old_manifest, number + "|answer", std::string()) == key and
+            fs::is_file(output).ok)
+            continue;
+
+        // The samples are the first tests (and are never compressed), so their answers may be
+        // on the manifest of the tests, with the same keys
+        FileLock tests_lock(std::string(CP_TOOLS_BUILD_DIR) + "/tests.lock");
+
+        if (tests.is_null())
+            tests = read_manifest();
+
+        auto test_output = std::string(CP_TOOLS_BUILD_DIR) + "/output/" + number;
+
+        if (util::get_json_value(tests, number + "|answer", std::string()) == key and
+            fs::copy(test_output, output, true).ok)
+            continue;
+
+        pending.push_back(io_files.size() - 1);
     }
 
-    return io_files;
+    std::vector<std::string> errors(pending.size());
+
+    parallel::for_each(pending.size(), [&](size_t i) {
+        auto [input, output] = io_files[pending[i]];
+        auto res = sh::execute(solution.output, "", input, output);
+
+        if (res.rc != CP_TOOLS_OK)
+            errors[i] = message::failure("Can't generate output for input '" + input + "'!") +
+                        "\n" + message::trace(res.output) + "\n";
+    });
+
+    bool failed = false;
+
+    for (size_t i = 0; i < errors.size(); ++i) {
+        if (not errors[i].empty())
+            samples_manifest.erase(std::to_string(pending[i] + 1));
+
+        err << errors[i];
+        failed |= not errors[i].empty();
+    }
+
+    fs::overwrite_file(manifest_file, samples_manifest.dump(4));
+
+    return failed ? std::vector<std::pair<std::string, std::string>>{} : io_files;
+}
+
+build::Target solution_target() {
+    auto config = cptools::config::read_config_file();
+    auto source = cptools::util::get_json_value(config, "solutions|default", std::string());
+
+    return {std::string(CP_TOOLS_BUILD_DIR) + "/solution", source,
+            config::get_compiler_profile(config,
+                                         config::get_solution_profile_name(config, source))};
 }
 
 int build_tools(std::string &error, int tools, const std::string &where) {
+    std::ostringstream out;
+
+    return build_targets(error, out, tools, {}, where);
+}
+
+int build_targets(std::string &error, std::ostream &out, int tools,
+                  const std::vector<build::Target> &extra, const std::string &where) {
+    std::map<std::string, std::string> optional_errors;
+
+    return build_targets(error, out, tools, extra, {}, optional_errors, where);
+}
+
+int build_targets(std::string &error, std::ostream &out, int tools,
+                  const std::vector<build::Target> &extra,
+                  const std::vector<build::Target> &optional,
+                  std::map<std::string, std::string> &optional_errors, const std::string &where) {
     auto dest_dir{where + "/" + CP_TOOLS_BUILD_DIR + "/"};
 
     auto fs_res = fs::create_directory(dest_dir);
@@ -140,11 +675,17 @@ int build_tools(std::string &error, int tools, const std::string &where) {
     }
 
     auto config = cptools::config::read_config_file();
+    auto profile = config::get_compiler_profile(config);
+
+    std::vector<build::Target> targets;
 
     for (int mask = 1; mask <= tools; mask <<= 1) {
         int tool = tools & mask;
         std::string program = "";
 
+        if (tool == 0)
+            continue;
+
         switch (tool) {
         case tools::VALIDATOR:
             program = "validator";
@@ -174,18 +715,53 @@ int build_tools(std::string &error, int tools, const std::string &where) {
             return CP_TOOLS_ERROR_TASK_INVALID_TOOL;
         }
 
-        auto dest = dest_dir + program;
+        targets.push_back({dest_dir + program, source, profile});
+    }
 
-        auto res = cptools::sh::build(dest, source);
+    targets.insert(targets.end(), extra.begin(), extra.end());
+    targets.insert(targets.end(), optional.begin(), optional.end());
 
-        if (res.rc != CP_TOOLS_OK) {
-            error + message::failure("Can't compile '" + source + "'!") + "\n";
-            error + message::trace(res.output) + '\n';
-            return res.rc;
+    // All targets are compiled at once and each one is reported as soon as it is done
+    int rc = CP_TOOLS_OK;
+    std::set<std::string> optional_outputs;
+
+    for (const auto &target : optional)
+        optional_outputs.insert(target.output);
+
+    size_t up_to_date = 0;
+
+    build::run(targets, [&](const build::Report &report) {
+        if (report.result.rc == CP_TOOLS_OK and not report.rebuilt) {
+            ++up_to_date;
+            return;
         }
-    }
 
-    return CP_TOOLS_OK;
+        if (report.result.rc == CP_TOOLS_OK) {
+            char elapsed[64];
+            sprintf(elapsed, "%.2f", report.elapsed);
+
+            out << message::info("Built '" + report.target.source + "' -> '" +
+                                 report.target.output + "' (" + elapsed + "s)")
+                << '\n';
+            return;
+        }
+
+        if (optional_outputs.count(report.target.output)) {
+            optional_errors[report.target.source] = report.result.output;
+            return;
+        }
+
+        error += message::failure("Can't compile '" + report.target.source + "'!") + "\n";
+        error += message::trace(report.result.output) + '\n';
+
+        if (rc == CP_TOOLS_OK)
+            rc = report.result.rc;
+    });
+
+    if (up_to_date > 0)
+        out << message::info(std::to_string(up_to_date) + " target(s) already up to date") << '\n';
+
+    return rc;
 }
 
 int gen_exe(std::string &error, const std::string &source, const std::string &dest,
@@ -205,7 +781,8 @@ int gen_exe(std::string &error, const std::string &source, const std::string &de
         return removed_result.rc;
     }
 
-    auto res = sh::build(program, source);
+    auto config = cptools::config::read_config_file();
+    auto res = sh::build(program, source, config::get_compiler_profile(config));
 
     if (res.rc != CP_TOOLS_OK) {
         error += message::failure("Can't build solution '" + source + "'!") + "\n";
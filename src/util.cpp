@@ -64,21 +64,46 @@ std::vector<std::string> split(const std::string &s, char delim) {
     return tokens;
 }
 
+static std::string to_hex(const unsigned char *hash, int size) {
+    std::ostringstream output;
+
+    output << std::hex << std::setfill('0');
+    for (int i = 0; i < size; i++) {
+        output << std::setw(2) << (int)hash[i];
+    }
+
+    return output.str();
+}
+
 std::string sha_512(const std::string &s) {
     unsigned char hash[SHA512_DIGEST_LENGTH];
-    std::ostringstream output;
     SHA512_CTX sha512;
 
     SHA512_Init(&sha512);
     SHA512_Update(&sha512, s.c_str(), s.size());
     SHA512_Final(hash, &sha512);
 
-    output << std::hex << std::setfill('0');
-    for (int i = 0; i < SHA512_DIGEST_LENGTH; i++) {
-        output << std::setw(2) << (int)hash[i];
-    }
+    return to_hex(hash, SHA512_DIGEST_LENGTH);
+}
 
-    return output.str();
+std::string sha_512_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+
+    if (not in)
+        return "";
+
+    unsigned char hash[SHA512_DIGEST_LENGTH];
+    SHA512_CTX sha512;
+    char buffer[64 * 1024];
+
+    SHA512_Init(&sha512);
+
+    while (in.read(buffer, sizeof buffer) or in.gcount() > 0)
+        SHA512_Update(&sha512, buffer, in.gcount());
+
+    SHA512_Final(hash, &sha512);
+
+    return to_hex(hash, SHA512_DIGEST_LENGTH);
 }
 
 static std::string strip(const std::string &s, const std::string &delim) {
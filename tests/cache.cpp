@@ -0,0 +1,68 @@
+#include <filesystem>
+#include <string>
+
+#include "cache.h"
+#include "catch.hpp"
+#include "dirs.h"
+#include "fs.h"
+
+SCENARIO("User-wide build cache", "[cache]") {
+    GIVEN("An enabled cache with room for two entries") {
+        std::string root{std::string(CP_TOOLS_TEMP_DIR) + "/cache-test"};
+        cptools::cache::Settings settings{true, root + "/cache", 20};
+
+        cptools::fs::remove(root);
+        std::filesystem::create_directories(root);
+
+        cptools::fs::overwrite_file(root + "/a", "0123456789");
+        cptools::fs::overwrite_file(root + "/b", "abcdefghij");
+        cptools::fs::overwrite_file(root + "/c", "ABCDEFGHIJ");
+
+        WHEN("A key was never stored") {
+            THEN("fetch() misses") {
+                REQUIRE(not cptools::cache::fetch(settings, "missing", root + "/out"));
+                REQUIRE(not cptools::fs::exists(root + "/out").ok);
+            }
+        }
+
+        WHEN("A key is stored") {
+            REQUIRE(cptools::cache::store(settings, "key-a", root + "/a"));
+
+            THEN("fetch() restores its contents") {
+                REQUIRE(cptools::cache::fetch(settings, "key-a", root + "/out"));
+                REQUIRE(cptools::fs::read_file(root + "/out") == "0123456789");
+            }
+        }
+
+        WHEN("The cache grows beyond its maximum size") {
+            auto old = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+
+            REQUIRE(cptools::cache::store(settings, "key-a", root + "/a"));
+            REQUIRE(cptools::cache::store(settings, "key-b", root + "/b"));
+
+            std::filesystem::last_write_time(root + "/cache/key-a", old);
+            std::filesystem::last_write_time(root + "/cache/key-b", old);
+
+            // A hit makes key-a the most recently used entry
+            REQUIRE(cptools::cache::fetch(settings, "key-a", root + "/out"));
+            REQUIRE(cptools::cache::store(settings, "key-c", root + "/c"));
+
+            THEN("The least recently used entry is evicted") {
+                REQUIRE(cptools::cache::fetch(settings, "key-a", root + "/out"));
+                REQUIRE(not cptools::cache::fetch(settings, "key-b", root + "/out"));
+                REQUIRE(cptools::cache::fetch(settings, "key-c", root + "/out"));
+            }
+        }
+
+        WHEN("The cache is disabled") {
+            settings.enabled = false;
+
+            THEN("Nothing is stored") {
+                REQUIRE(not cptools::cache::store(settings, "key-a", root + "/a"));
+                REQUIRE(not cptools::fs::exists(root + "/cache/key-a").ok);
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
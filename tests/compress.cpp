@@ -0,0 +1,55 @@
+#include <filesystem>
+#include <string>
+
+#include "catch.hpp"
+#include "compress.h"
+#include "dirs.h"
+#include "fs.h"
+
+SCENARIO("Compressed test files", "[compress]") {
+    GIVEN("A plain file") {
+        std::string root{std::string(CP_TOOLS_TEMP_DIR) + "/compress-test"};
+        std::string contents(200000, 'x');
+
+        for (size_t i = 0; i < contents.size(); i += 7)
+            contents[i] = '\n';
+
+        cptools::fs::remove(root);
+        std::filesystem::create_directories(root);
+        cptools::fs::overwrite_file(root + "/a", contents);
+
+        WHEN("It is compressed and decompressed back") {
+            REQUIRE(cptools::compress::compress(root + "/a", root + "/a.gz").ok);
+            REQUIRE(cptools::compress::decompress(root + "/a.gz", root + "/b").ok);
+
+            THEN("The contents are the same") {
+                REQUIRE(cptools::compress::is_compressed(root + "/a.gz"));
+                REQUIRE(cptools::fs::read_file(root + "/b") == contents);
+            }
+        }
+
+        WHEN("Its plain version is requested") {
+            std::string plain;
+
+            REQUIRE(cptools::compress::compress(root + "/a", root + "/a.gz").ok);
+            REQUIRE(cptools::compress::plain_file(root + "/a", root + "/cache", plain).ok);
+            REQUIRE(plain == root + "/a");
+
+            THEN("Only compressed files are decompressed into the cache") {
+                REQUIRE(cptools::compress::plain_file(root + "/a.gz", root + "/cache", plain).ok);
+                REQUIRE(plain.find(root + "/cache/") == 0);
+                REQUIRE(cptools::fs::read_file(plain) == contents);
+            }
+        }
+
+        WHEN("A corrupted file is decompressed") {
+            cptools::fs::overwrite_file(root + "/c.gz", "not gzip");
+
+            THEN("It fails") {
+                REQUIRE(not cptools::compress::decompress(root + "/c.gz", root + "/c").ok);
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
@@ -0,0 +1,16 @@
+#include "catch.hpp"
+
+#include "commands/contest/pdf.h"
+
+SCENARIO("Labels of the problems of a contest", "[contest]") {
+    GIVEN("The positions of the problems") {
+        THEN("They are labeled as the columns of a spreadsheet") {
+            REQUIRE(cptools::commands::contest::pdf::label(0) == "A");
+            REQUIRE(cptools::commands::contest::pdf::label(25) == "Z");
+            REQUIRE(cptools::commands::contest::pdf::label(26) == "AA");
+            REQUIRE(cptools::commands::contest::pdf::label(27) == "AB");
+            REQUIRE(cptools::commands::contest::pdf::label(701) == "ZZ");
+            REQUIRE(cptools::commands::contest::pdf::label(702) == "AAA");
+        }
+    }
+}
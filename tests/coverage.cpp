@@ -0,0 +1,36 @@
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "coverage.h"
+
+SCENARIO("Validator coverage", "[coverage]") {
+    GIVEN("The overview logs of some tests") {
+        cptools::coverage::Report report;
+
+        cptools::coverage::merge(report, 1,
+                                 "\"n\": min-value-hit\n\"x\":\nfeature \"sorted\": hit\n");
+        cptools::coverage::merge(report, 2, "\"n\": min-value-hit max-value-hit\n\"x\":\n");
+        cptools::coverage::merge(report, 3, "\"n\": max-value-hit\nfeature \"sorted\":\n");
+
+        THEN("The hits of each variable are merged") {
+            REQUIRE(report.variables.size() == 2);
+            REQUIRE(report.variables["n"].min_hits == std::vector<int>{1, 2});
+            REQUIRE(report.variables["n"].max_hits == std::vector<int>{2, 3});
+            REQUIRE(report.variables["x"].min_hits.empty());
+            REQUIRE(report.variables["x"].max_hits.empty());
+        }
+
+        THEN("The hits of each feature are merged") {
+            REQUIRE(report.features["sorted"] == std::vector<int>{1});
+        }
+    }
+
+    GIVEN("A list of tests") {
+        THEN("Consecutive tests are shown as ranges") {
+            REQUIRE(cptools::coverage::ranges({}) == "");
+            REQUIRE(cptools::coverage::ranges({4}) == "4");
+            REQUIRE(cptools::coverage::ranges({1, 2, 3, 7, 9, 10}) == "1-3, 7, 9-10");
+        }
+    }
+}
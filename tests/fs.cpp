@@ -0,0 +1,66 @@
+#include <filesystem>
+#include <string>
+
+#include "catch.hpp"
+#include "dirs.h"
+#include "fs.h"
+
+SCENARIO("File materialisation", "[fs]") {
+    GIVEN("A source file") {
+        std::string root{std::string(CP_TOOLS_TEMP_DIR) + "/materialize-test"};
+
+        cptools::fs::remove(root);
+        std::filesystem::create_directories(root + "/src/sub");
+
+        cptools::fs::overwrite_file(root + "/src/a", "0123456789");
+        cptools::fs::overwrite_file(root + "/src/sub/b", "abcdefghij");
+
+        WHEN("It is materialised without links") {
+            REQUIRE(cptools::fs::materialize(root + "/src/a", root + "/a").ok);
+
+            THEN("The copy has the same contents, but is another file") {
+                REQUIRE(cptools::fs::read_file(root + "/a") == "0123456789");
+                REQUIRE(not std::filesystem::equivalent(root + "/src/a", root + "/a"));
+            }
+        }
+
+        WHEN("It is materialised with links allowed") {
+            REQUIRE(cptools::fs::materialize(root + "/src/a", root + "/a", true).ok);
+
+            THEN("The copy has the same contents") {
+                REQUIRE(cptools::fs::read_file(root + "/a") == "0123456789");
+            }
+        }
+
+        WHEN("The destination already has the same contents") {
+            cptools::fs::overwrite_file(root + "/a", "0123456789");
+            auto links = std::filesystem::hard_link_count(root + "/a");
+
+            REQUIRE(cptools::fs::materialize(root + "/src/a", root + "/a", true).ok);
+
+            THEN("It is kept as it is") {
+                REQUIRE(std::filesystem::hard_link_count(root + "/a") == links);
+                REQUIRE(not std::filesystem::equivalent(root + "/src/a", root + "/a"));
+            }
+        }
+
+        WHEN("The destination has other contents") {
+            cptools::fs::overwrite_file(root + "/a", "old");
+
+            REQUIRE(cptools::fs::materialize(root + "/src/a", root + "/a").ok);
+
+            THEN("It is replaced") { REQUIRE(cptools::fs::read_file(root + "/a") == "0123456789"); }
+        }
+
+        WHEN("A directory is materialised") {
+            REQUIRE(cptools::fs::materialize(root + "/src", root + "/dst").ok);
+
+            THEN("The whole tree is copied") {
+                REQUIRE(cptools::fs::read_file(root + "/dst/a") == "0123456789");
+                REQUIRE(cptools::fs::read_file(root + "/dst/sub/b") == "abcdefghij");
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
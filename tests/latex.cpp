@@ -0,0 +1,51 @@
+#include <filesystem>
+#include <string>
+
+#include "catch.hpp"
+#include "dirs.h"
+#include "fs.h"
+#include "latex.h"
+
+SCENARIO("Sources of a PDF", "[latex]") {
+    GIVEN("A LaTeX file that names other files") {
+        std::string root{std::string(CP_TOOLS_TEMP_DIR) + "/latex-test"};
+
+        cptools::fs::remove(root);
+        std::filesystem::create_directories(root);
+
+        cptools::fs::overwrite_file(root + "/sample", "1 2\n");
+        cptools::fs::overwrite_file(root + "/statement.tex", "Some text");
+        cptools::fs::overwrite_file(root + "/other", "abc");
+
+        auto tex = "\\input{" + root + "/statement}\n\\iosample{6cm}{" + root + "/sample}\n";
+        cptools::fs::overwrite_file(root + "/problem.tex", tex);
+
+        auto hash = cptools::latex::sources_hash(root + "/problem.tex", "cp_modern");
+
+        WHEN("A named file changes") {
+            cptools::fs::overwrite_file(root + "/sample", "1 3\n");
+
+            THEN("The hash changes") {
+                REQUIRE(cptools::latex::sources_hash(root + "/problem.tex", "cp_modern") != hash);
+            }
+        }
+
+        WHEN("A file named without its extension changes") {
+            cptools::fs::overwrite_file(root + "/statement.tex", "Other text");
+
+            THEN("The hash changes") {
+                REQUIRE(cptools::latex::sources_hash(root + "/problem.tex", "cp_modern") != hash);
+            }
+        }
+
+        WHEN("Another file changes") {
+            cptools::fs::overwrite_file(root + "/other", "def");
+
+            THEN("The hash is the same") {
+                REQUIRE(cptools::latex::sources_hash(root + "/problem.tex", "cp_modern") == hash);
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
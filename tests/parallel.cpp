@@ -0,0 +1,41 @@
+#include <atomic>
+#include <vector>
+
+#include "catch.hpp"
+#include "parallel.h"
+
+SCENARIO("Parallel helpers", "[parallel]") {
+    GIVEN("A list of independent jobs") {
+        const size_t N = 1000;
+
+        WHEN("They are run by for_each()") {
+            THEN("Every job is run exactly once") {
+                for (size_t workers : {0, 1, 2, 7}) {
+                    std::vector<std::atomic<int>> calls(N);
+
+                    cptools::parallel::for_each(
+                        N, [&](size_t i) { ++calls[i]; }, workers);
+
+                    for (size_t i = 0; i < N; ++i)
+                        REQUIRE(calls[i] == 1);
+                }
+            }
+        }
+
+        WHEN("There are no jobs") {
+            THEN("The function is never called") {
+                int calls = 0;
+
+                cptools::parallel::for_each(0, [&](size_t) { ++calls; });
+
+                REQUIRE(calls == 0);
+            }
+        }
+    }
+
+    GIVEN("The current machine") {
+        THEN("There is at least one worker available") {
+            REQUIRE(cptools::parallel::max_workers() >= 1);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "script.h"
+
+SCENARIO("Generation scripts", "[script]") {
+    GIVEN("A script with single test calls") {
+        auto res = cptools::script::expand("# Small tests\n"
+                                           "gen 1 2 > $\n"
+                                           "\n"
+                                           "  other -n 5 > $  \n");
+
+        THEN("Each line is a generator call") {
+            REQUIRE(res.ok);
+            REQUIRE(res.commands.size() == 2);
+
+            REQUIRE(res.commands[0].generator == "gen");
+            REQUIRE(res.commands[0].args == "1 2");
+            REQUIRE(res.commands[0].tests.empty());
+
+            REQUIRE(res.commands[1].generator == "other");
+            REQUIRE(res.commands[1].args == "-n 5");
+        }
+    }
+
+    GIVEN("A script with loops") {
+        auto res = cptools::script::expand("for i in 1..3\n"
+                                           "    for j in ${i}..6 step 2\n"
+                                           "        gen ${i} ${j} > $\n"
+                                           "    end\n"
+                                           "end\n");
+
+        THEN("The calls are expanded with the values of the variables") {
+            std::vector<std::string> expected{"1 1", "1 3", "1 5", "2 2",
+                                              "2 4", "2 6", "3 3", "3 5"};
+
+            REQUIRE(res.ok);
+            REQUIRE(res.commands.size() == expected.size());
+
+            for (size_t i = 0; i < expected.size(); ++i)
+                REQUIRE(res.commands[i].args == expected[i]);
+        }
+    }
+
+    GIVEN("A call that writes many tests") {
+        auto res = cptools::script::expand("gen 100 > {1-3,7}");
+
+        THEN("The call has the indexes of its tests") {
+            REQUIRE(res.ok);
+            REQUIRE(res.commands.size() == 1);
+            REQUIRE(res.commands[0].tests == std::vector<int>{1, 2, 3, 7});
+        }
+    }
+
+    GIVEN("Loops on the limits of the integers") {
+        auto res = cptools::script::expand(
+            "for i in 9223372036854775800..9223372036854775807 step 5\n"
+            "    gen ${i} > $\n"
+            "end\n");
+
+        THEN("The variable never steps past the last value") {
+            REQUIRE(res.ok);
+            REQUIRE(res.commands.size() == 2);
+            REQUIRE(res.commands[0].args == "9223372036854775800");
+            REQUIRE(res.commands[1].args == "9223372036854775805");
+        }
+
+        THEN("A range wider than the integers has too many iterations") {
+            auto wide = cptools::script::expand(
+                "for i in -9223372036854775807..9223372036854775807\nend\n");
+
+            REQUIRE(not wide.ok);
+            REQUIRE(wide.error_message.find("too many iterations") != std::string::npos);
+        }
+    }
+
+    GIVEN("Nested loops that don't write tests") {
+        auto res = cptools::script::expand("for i in 1..1000\n"
+                                           "    for j in 1..1000\n"
+                                           "        for k in 1..1000\n"
+                                           "        end\n"
+                                           "    end\n"
+                                           "end\n");
+
+        THEN("The iterations of all loops are bounded") {
+            REQUIRE(not res.ok);
+            REQUIRE(res.error_message.find("too many iterations") != std::string::npos);
+        }
+    }
+
+    GIVEN("Invalid scripts") {
+        THEN("The error tells the line") {
+            for (auto script : {"gen 1 2", "for i in 1..3\ngen > $", "end", "gen ${k} > $",
+                                "gen > {3-1}", "for i in 1..3 step 0\nend", "gen > out",
+                                "gen > {1,1,2}", "gen > {1-3,2}"}) {
+                auto res = cptools::script::expand(script);
+
+                REQUIRE(not res.ok);
+                REQUIRE(res.error_message.find("Line ") == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "dirs.h"
+#include "error.h"
+#include "fs.h"
+#include "task.h"
+
+// The tasks work on the problem of the working directory, which is restored even if a test fails
+struct ProblemDirectory {
+    std::filesystem::path previous;
+
+    ProblemDirectory(const std::string &dir) : previous(std::filesystem::current_path()) {
+        std::filesystem::current_path(dir);
+    }
+
+    ~ProblemDirectory() { std::filesystem::current_path(previous); }
+};
+
+// A problem whose solution echoes the input, with the given manual tests
+static void write_problem(const std::string &root, const std::vector<std::string> &inputs) {
+    std::string tests;
+
+    cptools::fs::remove(root);
+    std::filesystem::create_directories(root + "/solutions");
+    std::filesystem::create_directories(root + "/tests");
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        auto name = "tests/" + std::to_string(i + 1);
+
+        cptools::fs::overwrite_file(root + "/" + name, inputs[i]);
+        tests += (i ? ", " : "") + std::string("\"") + name + "\": \"\"";
+    }
+
+    cptools::fs::overwrite_file(root + "/config.json",
+                                "{ \"solutions\": { \"default\": \"solutions/solution.c\" }, "
+                                "\"tests\": { \"manual\": { " +
+                                    tests + " } } }");
+    cptools::fs::overwrite_file(root + "/solutions/solution.c",
+                                "#include <stdio.h>\n\n"
+                                "int main() {\n"
+                                "    int c;\n\n"
+                                "    while ((c = getchar()) != EOF)\n"
+                                "        putchar(c);\n\n"
+                                "    return 0;\n"
+                                "}\n");
+}
+
+SCENARIO("Generation of the tests", "[task]") {
+    GIVEN("A problem with two manual tests") {
+        auto root = std::filesystem::absolute(CP_TOOLS_TEMP_DIR "/task-test").string();
+
+        write_problem(root, {"1\n", "2\n"});
+
+        {
+            ProblemDirectory problem(root);
+            std::ostringstream out, err;
+
+            auto io_files = cptools::task::generate_io_files("manual", out, err);
+
+            REQUIRE(io_files.size() == 2);
+            REQUIRE(cptools::fs::read_file(io_files[0].second) == "1\n");
+            REQUIRE(cptools::fs::read_file(io_files[1].second) == "2\n");
+
+            // An answer that is regenerated is written over by the solution
+            cptools::fs::overwrite_file(io_files[0].second, "kept\n");
+            cptools::fs::overwrite_file(io_files[1].second, "kept\n");
+
+            WHEN("The tests are generated again, with no changes") {
+                io_files = cptools::task::generate_io_files("manual", out, err);
+
+                THEN("The answers of the manifest are reused") {
+                    REQUIRE(io_files.size() == 2);
+                    REQUIRE(cptools::fs::read_file(io_files[0].second) == "kept\n");
+                    REQUIRE(cptools::fs::read_file(io_files[1].second) == "kept\n");
+                }
+            }
+
+            WHEN("The source of a test changes") {
+                cptools::fs::overwrite_file("tests/1", "3\n");
+
+                io_files = cptools::task::generate_io_files("manual", out, err);
+
+                THEN("Only that test is generated again") {
+                    REQUIRE(io_files.size() == 2);
+                    REQUIRE(cptools::fs::read_file(io_files[0].first) == "3\n");
+                    REQUIRE(cptools::fs::read_file(io_files[0].second) == "3\n");
+                    REQUIRE(cptools::fs::read_file(io_files[1].second) == "kept\n");
+                }
+            }
+
+            WHEN("A build input is written over") {
+                cptools::fs::overwrite_file(io_files[0].first, "changed\n");
+
+                THEN("The test of the problem is not changed") {
+                    REQUIRE(cptools::fs::read_file("tests/1") == "1\n");
+                }
+            }
+
+            WHEN("The manifest is lost") {
+                cptools::fs::remove(std::string(CP_TOOLS_BUILD_DIR) + "/tests.json");
+
+                io_files = cptools::task::generate_io_files("manual", out, err);
+
+                THEN("All tests are generated again") {
+                    REQUIRE(io_files.size() == 2);
+                    REQUIRE(cptools::fs::read_file(io_files[0].second) == "1\n");
+                    REQUIRE(cptools::fs::read_file(io_files[1].second) == "2\n");
+                }
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
+
+SCENARIO("Streaming of the tests", "[task]") {
+    GIVEN("A problem with three manual tests") {
+        auto root = std::filesystem::absolute(CP_TOOLS_TEMP_DIR "/task-test").string();
+
+        write_problem(root, {"1\n", "2\n", "3\n"});
+
+        {
+            ProblemDirectory problem(root);
+            std::ostringstream out, err;
+            std::vector<size_t> consumed;
+
+            WHEN("The consumer takes every test") {
+                auto rc = cptools::task::stream_io_files(
+                    "manual", out, err, [&](size_t i, size_t, const std::string &input,
+                                            const std::string &answer) {
+                        consumed.push_back(i);
+                        return cptools::fs::read_file(input) == cptools::fs::read_file(answer);
+                    });
+
+                THEN("The tests are handed in order, with their answers") {
+                    REQUIRE(rc == CP_TOOLS_OK);
+                    REQUIRE(consumed == std::vector<size_t>{0, 1, 2});
+                }
+            }
+
+            WHEN("The consumer stops at the first test") {
+                auto rc = cptools::task::stream_io_files(
+                    "manual", out, err,
+                    [&](size_t i, size_t, const std::string &, const std::string &) {
+                        consumed.push_back(i);
+                        return false;
+                    });
+
+                THEN("No other test is handed to it") {
+                    REQUIRE(rc == CP_TOOLS_OK);
+                    REQUIRE(consumed == std::vector<size_t>{0});
+                }
+
+                THEN("The tests skipped are still made by the next generation") {
+                    auto io_files = cptools::task::generate_io_files("manual", out, err);
+
+                    REQUIRE(io_files.size() == 3);
+
+                    for (size_t i = 0; i < io_files.size(); ++i)
+                        REQUIRE(cptools::fs::read_file(io_files[i].second) ==
+                                std::to_string(i + 1) + "\n");
+                }
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
+
+SCENARIO("Tests with the same input", "[task]") {
+    GIVEN("A problem whose first, third and fourth tests have the same input") {
+        auto root = std::filesystem::absolute(CP_TOOLS_TEMP_DIR "/task-test").string();
+
+        write_problem(root, {"1\n", "2\n", "1\n", "1\n"});
+
+        {
+            ProblemDirectory problem(root);
+            std::ostringstream out, err;
+            std::vector<size_t> originals;
+
+            auto consumer = [&](size_t, size_t original, const std::string &,
+                                const std::string &) {
+                originals.push_back(original);
+                return true;
+            };
+
+            WHEN("The tests are streamed") {
+                auto rc = cptools::task::stream_io_files("manual", out, err, consumer);
+
+                THEN("Each test is handed with the first test of its input") {
+                    REQUIRE(rc == CP_TOOLS_OK);
+                    REQUIRE(originals == std::vector<size_t>{0, 1, 0, 0});
+                }
+
+                THEN("The repeated inputs are reported") {
+                    REQUIRE(out.str().find("Tests 3, 4 repeat the input of test 1") !=
+                            std::string::npos);
+                }
+            }
+
+            WHEN("A repeated input changes") {
+                REQUIRE(cptools::task::stream_io_files("manual", out, err, consumer) ==
+                        CP_TOOLS_OK);
+
+                cptools::fs::overwrite_file("tests/3", "2\n");
+                originals.clear();
+
+                auto rc = cptools::task::stream_io_files("manual", out, err, consumer);
+
+                THEN("The duplicates are found from the new contents") {
+                    REQUIRE(rc == CP_TOOLS_OK);
+                    REQUIRE(originals == std::vector<size_t>{0, 1, 1, 0});
+                }
+            }
+        }
+
+        cptools::fs::remove(root);
+    }
+}
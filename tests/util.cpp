@@ -1,4 +1,5 @@
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -236,3 +237,29 @@ SCENARIO("Utilitary functions", "[util]") {
         }
     }
 }
+
+SCENARIO("File hashing", "[util]") {
+    GIVEN("A file larger than the read block") {
+        auto path = std::filesystem::temp_directory_path() / "cp-tools-sha-test";
+        std::string contents(200000, 'x');
+
+        for (size_t i = 0; i < contents.size(); i += 7)
+            contents[i] = 'a' + (i % 26);
+
+        std::ofstream(path, std::ios::binary) << contents;
+
+        WHEN("The file is hashed") {
+            THEN("The hash is the same of its contents") {
+                REQUIRE(cptools::util::sha_512_file(path) == cptools::util::sha_512(contents));
+            }
+        }
+
+        WHEN("The file doesn't exist") {
+            std::filesystem::remove(path);
+
+            THEN("The hash is empty") { REQUIRE(cptools::util::sha_512_file(path).empty()); }
+        }
+
+        std::filesystem::remove(path);
+    }
+}